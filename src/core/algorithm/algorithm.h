@@ -67,6 +67,18 @@ move_n_backward(BidirIt1 last, size_t n, BidirIt2 result_back) {
     return result_back;
 }
 
+// 把不满足 pred 的元素依次移动到前面，保持相对顺序，返回新的结尾；只遍历一遍，每个保留的元素最多移动一次
+template<class ForwardIt, class UnaryPredicate>
+constexpr ForwardIt
+remove_if(ForwardIt first, ForwardIt last, UnaryPredicate pred) {
+    while (first != last && !pred(*first)) ++first;
+    if (first == last) return first;
+    for (ForwardIt it = first; ++it != last;) {
+        if (!pred(*it)) *first++ = std::move(*it);
+    }
+    return first;
+}
+
 #pragma endregion
 
 
@@ -342,10 +342,10 @@ public:
     using propagate_on_container_move_assignment = std::true_type;
     using is_always_equal                        = std::true_type;
 
-    // 重新绑定分配器
+    // 重新绑定分配器，底层配置器不变
     template<class U>
     struct rebind {
-        using other = allocator<U>;
+        using other = allocator<U, Alloc>;
     };
 
 public:
@@ -414,6 +414,11 @@ private:
     };
 };
 
+// 直接使用第一级配置器的分配器，不经过全局的内存池，可以在多个线程上同时分配；
+// 并发容器用它分配自己的结点和桶数组
+template<class T>
+using malloc_allocator = allocator<T, malloc_alloc>;
+
 #pragma endregion
 
 template<typename T>
@@ -0,0 +1,169 @@
+//
+// Created by Anya on 2023/8/28.
+//
+
+#ifndef ANYA_STL_NODE_SLAB_HPP
+#define ANYA_STL_NODE_SLAB_HPP
+
+#include "allocator/memory.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace anya {
+
+// 只给一个容器使用的结点池
+// 按块向全局分配器申请内存，结点从当前块中依次切出，同一个容器的结点挨在一起；回收的结点挂在空闲链表上，下次优先复用
+// release() 一次归还所有块而不逐个回收结点，元素可以平凡析构时容器的 clear() 和析构不需要遍历结点
+// 块从64个结点开始，每次翻倍，最多65536个结点；不是线程安全的
+template<class Node>
+class node_slab {
+private:
+    union slot {
+        slot* next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    // 块头之后紧跟着 count 个结点
+    struct alignas(slot) block {
+        block* prev;
+        size_t count;
+
+        slot*
+        slots() noexcept { return reinterpret_cast<slot*>(this + 1); }
+    };
+
+    static_assert(alignof(slot) <= alignof(std::max_align_t), "anya::node_slab does not support over-aligned nodes");
+
+    constexpr static size_t first_block = 64;
+    constexpr static size_t max_block   = 65536;
+
+    slot*  free_list{};            // 回收的结点
+    slot*  cursor{};               // 当前块中下一个没用过的结点
+    slot*  limit{};                // 当前块的末尾
+    block* blocks{};               // 所有块组成的单链表，最新的在前
+    size_t next_count = first_block;
+
+    anya::allocator<unsigned char> alloc{};
+
+public:
+    node_slab() noexcept = default;
+
+    node_slab(const node_slab&) = delete;
+
+    node_slab(node_slab&& other) noexcept { swap(other); }
+
+    node_slab&
+    operator=(node_slab&& other) noexcept {
+        node_slab(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~node_slab() { release(); }
+
+    // 与 anya::allocator 接口相同，n只能为1
+    [[nodiscard]] Node*
+    allocate(size_t n = 1) {
+        (void) n;
+        if (free_list) {
+            slot* result = free_list;
+            free_list = free_list->next;
+            return reinterpret_cast<Node*>(result);
+        }
+        if (cursor == limit) add_block();
+        return reinterpret_cast<Node*>(cursor++);
+    }
+
+    void
+    deallocate(Node* node, size_t = 1) noexcept {
+        auto* s = reinterpret_cast<slot*>(node);
+        s->next = free_list, free_list = s;
+    }
+
+    // 归还所有块，之前分配的结点全部失效，调用者需要先析构其中的元素
+    void
+    release() noexcept {
+        while (blocks) {
+            block* prev = blocks->prev;
+            alloc.deallocate(reinterpret_cast<unsigned char*>(blocks), block_bytes(blocks->count));
+            blocks = prev;
+        }
+        free_list = cursor = limit = nullptr;
+        next_count = first_block;
+    }
+
+    // 接管 other 的所有块与空闲结点，other 中已分配的结点从此属于本结点池
+    void
+    adopt(node_slab& other) noexcept {
+        if (&other == this || other.blocks == nullptr) return;
+        // other 当前块中没用过的结点放进空闲链表
+        while (other.cursor != other.limit) other.deallocate(reinterpret_cast<Node*>(other.cursor++));
+        if (blocks) {
+            // 新块接在本结点池最旧的块后面，当前块不变
+            block* oldest = blocks;
+            while (oldest->prev) oldest = oldest->prev;
+            oldest->prev = other.blocks;
+        }
+        else {
+            blocks = other.blocks;
+        }
+        if (other.free_list) {
+            slot* last = other.free_list;
+            while (last->next) last = last->next;
+            last->next = free_list, free_list = other.free_list;
+        }
+        other.blocks = nullptr;
+        other.free_list = other.cursor = other.limit = nullptr;
+        other.next_count = first_block;
+    }
+
+    void
+    swap(node_slab& other) noexcept {
+        std::swap(free_list, other.free_list);
+        std::swap(cursor, other.cursor);
+        std::swap(limit, other.limit);
+        std::swap(blocks, other.blocks);
+        std::swap(next_count, other.next_count);
+    }
+
+private:
+    constexpr static size_t
+    block_bytes(size_t count) noexcept { return sizeof(block) + count * sizeof(slot); }
+
+    void
+    add_block() {
+        auto* fresh = reinterpret_cast<block*>(alloc.allocate(block_bytes(next_count)));
+        fresh->prev = blocks, fresh->count = next_count;
+        blocks = fresh;
+        cursor = fresh->slots(), limit = cursor + next_count;
+        if (next_count < max_block) next_count *= 2;
+    }
+};
+
+// 与 anya::allocator 相同，作为容器的 Allocator 参数时，容器的结点从容器自己的 node_slab 中分配
+//
+//   anya::list<int, anya::slab_allocator<int>> list;
+//   anya::unordered_map<int, int, anya::hash<int>, std::equal_to<int>, anya::slab_allocator<std::pair<const int, int>>> map;
+template<class T>
+class slab_allocator : public anya::allocator<T> {
+public:
+    template<class U>
+    struct rebind {
+        using other = slab_allocator<U>;
+    };
+};
+
+template<class Alloc>
+struct is_slab_allocator : std::false_type {};
+
+template<class T>
+struct is_slab_allocator<slab_allocator<T>> : std::true_type {};
+
+// 结点分配器：Allocator 为 slab_allocator 时是容器私有的 node_slab，否则是 Allocator 重新绑定到结点类型
+template<class Allocator, class Node>
+using node_allocator_t = std::conditional_t<is_slab_allocator<Allocator>::value, node_slab<Node>,
+                                            typename Allocator::template rebind<Node>::other>;
+
+}
+
+#endif //ANYA_STL_NODE_SLAB_HPP
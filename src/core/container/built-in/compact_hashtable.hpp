@@ -0,0 +1,477 @@
+//
+// Created by Anya on 2023/8/27.
+//
+
+#ifndef ANYA_STL_COMPACT_HASHTABLE_HPP
+#define ANYA_STL_COMPACT_HASHTABLE_HPP
+
+#include "container/vector.hpp"
+#include "container/built-in/compact_storage.hpp"
+#include "container/built-in/hash_policy.hpp"
+#include "functional/hash.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+
+namespace anya {
+
+// 用32位下标连接的开链哈希表，适合元素很多、每个元素很小的场景
+// 元素紧密地放在一个数组里，下标为 [0, size())；链接放在另一个同样长的32位数组里，桶数组也只存32位下标：
+// 每个元素只比元素本身多4字节链接，而 hashtable 的每个结点还要多一个8字节指针和一次单独的分配
+// 遍历就是顺序扫描元素数组，迭代器是元素指针；元素只能平凡复制时，复制整个表只需要复制三块内存
+// 删除时把最后一个元素移到空出的位置，所以元素需要能不抛出异常地移动构造，删除会使指向最后一个元素的迭代器、指针和引用失效；
+// 插入导致扩容时所有指针和引用都会失效。最多容纳 2^32 - 1 个元素
+template<
+    class Key,
+    class T,
+    class Hash         = anya::hash<Key>,
+    class KeyEqual     = std::equal_to<Key>,
+    class RehashPolicy = anya::default_rehash_policy,
+    class KeyPolicy    = anya::map_key_policy<Key, T>>
+class compact_hashtable {
+private:
+    constexpr static bool is_map = KeyPolicy::is_map;
+
+    static_assert(std::is_nothrow_move_constructible_v<typename KeyPolicy::value_type>,
+                  "anya::compact_hashtable moves the last element on erase, it must be nothrow move constructible");
+
+public:
+    using key_type        = Key;
+    using mapped_type     = T;
+    using value_type      = typename KeyPolicy::value_type;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using pointer         = value_type*;
+    using const_pointer   = const value_type*;
+    // 集合的元素不能修改
+    using iterator        = std::conditional_t<is_map, value_type*, const value_type*>;
+    using const_iterator  = const value_type*;
+
+private:
+    using index_container = anya::vector<compact_index>;
+
+    compact_storage<value_type> values{};    // 元素数组
+    index_container             next{};      // next[i] 为与元素i同一个桶的下一个元素
+    index_container             buckets{};   // 每个桶第一个元素的下标
+    size_t                      elements{};  // 元素数量
+    float                       factor = 1;  // 装载因子上限
+    [[no_unique_address]] hasher    hash_fcn{};
+    [[no_unique_address]] key_equal equal_fcn{};
+
+    // 默认桶的个数，实际个数由 RehashPolicy 取整
+    constexpr static size_t default_size = 11;
+
+#pragma region 构造 && 析构
+public:
+    compact_hashtable() : compact_hashtable(default_size) {}
+
+    explicit
+    compact_hashtable(size_t bucket_count, const hasher& hash = hasher(), const key_equal& equal = key_equal())
+        : buckets(RehashPolicy::next_bucket_count(bucket_count), compact_npos), hash_fcn(hash), equal_fcn(equal) {}
+
+    compact_hashtable(std::initializer_list<value_type> init) : compact_hashtable(init.size()) {
+        for (auto& value : init) emplace(value);
+    }
+
+    compact_hashtable(const compact_hashtable& other)
+        : next(other.next), buckets(other.buckets), factor(other.factor),
+          hash_fcn(other.hash_fcn), equal_fcn(other.equal_fcn) {
+        values.reserve(other.elements, 0);
+        if constexpr (std::is_trivially_copyable_v<value_type>) {
+            if (other.elements) std::memcpy(static_cast<void*>(values.data()), other.values.data(), other.elements * sizeof(value_type));
+        }
+        else {
+            anya::uninitialized_copy_n(other.values.data(), other.elements, values.data());
+        }
+        elements = other.elements;
+    }
+
+    compact_hashtable(compact_hashtable&& other) noexcept
+        : values(std::move(other.values)), next(std::move(other.next)), buckets(std::move(other.buckets)),
+          elements(std::exchange(other.elements, 0)), factor(other.factor),
+          hash_fcn(std::move(other.hash_fcn)), equal_fcn(std::move(other.equal_fcn)) {}
+
+    ~compact_hashtable() { anya::destroy(values.data(), values.data() + elements); }
+#pragma endregion
+
+
+#pragma region 赋值
+public:
+    compact_hashtable&
+    operator=(const compact_hashtable& other) {
+        if (this != &other) {
+            compact_hashtable temp(other);
+            swap(temp);
+        }
+        return *this;
+    }
+
+    compact_hashtable&
+    operator=(compact_hashtable&& other) noexcept {
+        if (this != &other) {
+            compact_hashtable temp(std::move(other));
+            swap(temp);
+        }
+        return *this;
+    }
+#pragma endregion
+
+
+#pragma region 迭代器
+public:
+    iterator
+    begin() noexcept { return values.data(); }
+
+    const_iterator
+    begin() const noexcept { return values.data(); }
+
+    const_iterator
+    cbegin() const noexcept { return begin(); }
+
+    iterator
+    end() noexcept { return values.data() + elements; }
+
+    const_iterator
+    end() const noexcept { return values.data() + elements; }
+
+    const_iterator
+    cend() const noexcept { return end(); }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] bool
+    empty() const noexcept { return elements == 0; }
+
+    [[nodiscard]] size_type
+    size() const noexcept { return elements; }
+
+    [[nodiscard]] constexpr size_type
+    max_size() const noexcept { return compact_max_size; }
+
+    // 元素数组、链接数组与桶数组占用的内存
+    [[nodiscard]] size_t
+    memory_usage() const noexcept {
+        return values.capacity() * sizeof(value_type) + next.capacity() * sizeof(compact_index)
+             + buckets.size() * sizeof(compact_index);
+    }
+#pragma endregion
+
+
+#pragma region 修改器
+public:
+    void
+    clear() noexcept {
+        anya::destroy(values.data(), values.data() + elements);
+        elements = 0;
+        next.clear();
+        std::fill(buckets.begin(), buckets.end(), compact_npos);
+    }
+
+    // 有空位时先在元素数组的末尾构造，key已经存在时再析构；
+    // 满了时先构造到临时对象中查找，key不存在才扩容，args 引用表中的元素时也不会读到扩容释放的内存
+    template<class... Args>
+    std::pair<iterator, bool>
+    emplace(Args&&... args) {
+        if (elements == values.capacity()) {
+            value_type temp(std::forward<Args>(args)...);
+            const Key& key = KeyPolicy::key(temp);
+            size_t code = hash_fcn(key);
+            compact_index exist = find_index(key, code);
+            if (exist != compact_npos) return {begin() + exist, false};
+            return {append(code, std::move(temp)), true};
+        }
+        value_type* slot = values.data() + elements;
+        values.construct(slot, std::forward<Args>(args)...);
+        const Key& key = KeyPolicy::key(*slot);
+        size_t code = hash_fcn(key);
+        compact_index exist = find_index(key, code);
+        if (exist != compact_npos) {
+            anya::destroy_at(slot);
+            return {begin() + exist, false};
+        }
+        try {
+            link_back(code);
+        }
+        catch (...) {
+            anya::destroy_at(slot);
+            throw;
+        }
+        return {begin() + (elements - 1), true};
+    }
+
+    std::pair<iterator, bool>
+    insert(const value_type& value) { return emplace(value); }
+
+    std::pair<iterator, bool>
+    insert(value_type&& value) { return emplace(std::move(value)); }
+
+    template<class InputIt>
+    void
+    insert(InputIt first, InputIt last) {
+        for (; first != last; ++first) emplace(*first);
+    }
+
+    // key不存在时才构造值
+    template<class... Args>
+    requires is_map
+    std::pair<iterator, bool>
+    try_emplace(const Key& key, Args&&... args) {
+        size_t code = hash_fcn(key);
+        compact_index exist = find_index(key, code);
+        if (exist != compact_npos) return {begin() + exist, false};
+        return {append(code, std::piecewise_construct, std::forward_as_tuple(key),
+                       std::forward_as_tuple(std::forward<Args>(args)...)), true};
+    }
+
+    template<class M>
+    requires is_map
+    std::pair<iterator, bool>
+    insert_or_assign(const Key& key, M&& obj) {
+        auto result = try_emplace(key, std::forward<M>(obj));
+        if (!result.second) result.first->second = std::forward<M>(obj);
+        return result;
+    }
+
+    // 删除pos处的元素，最后一个元素移到这里，返回的迭代器仍指向pos，边遍历边删除时不会跳过元素
+    iterator
+    erase(const_iterator pos) {
+        auto index = static_cast<compact_index>(pos - begin());
+        unlink(index, bucket_of(KeyPolicy::key(values[index])));
+        anya::destroy_at(values.data() + index);
+        auto last = static_cast<compact_index>(elements - 1);
+        if (index != last) {
+            values.construct(values.data() + index, std::move(values[last]));
+            anya::destroy_at(values.data() + last);
+            compact_index* link = &buckets[bucket_of(KeyPolicy::key(values[index]))];
+            while (*link != last) link = &next[*link];
+            *link = index, next[index] = next[last];
+        }
+        next.pop_back();
+        --elements;
+        return begin() + index;
+    }
+
+    size_type
+    erase(const Key& key) {
+        auto it = find(key);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+
+    void
+    swap(compact_hashtable& other) noexcept {
+        values.swap(other.values);
+        next.swap(other.next);
+        buckets.swap(other.buckets);
+        std::swap(elements, other.elements);
+        std::swap(factor, other.factor);
+        std::swap(hash_fcn, other.hash_fcn);
+        std::swap(equal_fcn, other.equal_fcn);
+    }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    iterator
+    find(const Key& key) {
+        compact_index index = find_index(key, hash_fcn(key));
+        return index == compact_npos ? end() : begin() + index;
+    }
+
+    const_iterator
+    find(const Key& key) const {
+        compact_index index = find_index(key, hash_fcn(key));
+        return index == compact_npos ? end() : begin() + index;
+    }
+
+    [[nodiscard]] bool
+    contains(const Key& key) const { return find(key) != end(); }
+
+    [[nodiscard]] size_type
+    count(const Key& key) const { return contains(key); }
+
+    T&
+    at(const Key& key) requires is_map {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("compact_hashtable has not this key");
+        return it->second;
+    }
+
+    const T&
+    at(const Key& key) const requires is_map {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("compact_hashtable has not this key");
+        return it->second;
+    }
+
+    T&
+    operator[](const Key& key) requires is_map { return try_emplace(key).first->second; }
+#pragma endregion
+
+
+#pragma region 哈希策略
+public:
+    [[nodiscard]] size_type
+    bucket_count() const noexcept { return buckets.size(); }
+
+    [[nodiscard]] float
+    load_factor() const noexcept { return static_cast<float>(elements) / static_cast<float>(buckets.size()); }
+
+    [[nodiscard]] float
+    max_load_factor() const noexcept { return factor; }
+
+    void
+    max_load_factor(float ml) {
+        if (ml <= 0 || std::isnan(ml)) throw std::invalid_argument("max_load_factor must be positive");
+        factor = ml;
+        if (is_overload(elements, buckets.size())) rehash(0);
+    }
+
+    // 桶数至少为count且能容纳现有元素，可能缩小
+    void
+    rehash(size_type count) {
+        size_t needed = std::ceil(static_cast<float>(elements) / factor);
+        size_t new_bucket_size = RehashPolicy::next_bucket_count(anya::max(count, needed));
+        if (new_bucket_size != buckets.size()) rebuild(new_bucket_size);
+    }
+
+    // 元素数组、链接数组与桶数组一次准备好count个元素的空间
+    void
+    reserve(size_type count) {
+        values.reserve(count, elements);
+        next.reserve(count);
+        if (is_overload(count, buckets.size())) rehash(std::ceil(static_cast<float>(count) / factor));
+    }
+#pragma endregion
+
+
+#pragma region 观察器
+public:
+    hasher
+    hash_function() const { return hash_fcn; }
+
+    key_equal
+    key_eq() const { return equal_fcn; }
+#pragma endregion
+
+
+#pragma region 工具函数
+private:
+    // 被移动后桶数组为空，下一次插入时重新分配
+    compact_index
+    find_index(const Key& key, size_t code) const {
+        if (buckets.empty()) return compact_npos;
+        compact_index index = buckets[RehashPolicy::index(code, buckets.size())];
+        while (index != compact_npos && !equal_fcn(KeyPolicy::key(values[index]), key)) index = next[index];
+        return index;
+    }
+
+    size_t
+    bucket_of(const Key& key) const { return RehashPolicy::index(hash_fcn(key), buckets.size()); }
+
+    // 在元素数组末尾构造元素并链入，调用者保证key不存在；
+    // 满了时先构造到临时对象中再扩容，args 引用表中的元素时扩容不会使它们失效
+    template<class... Args>
+    iterator
+    append(size_t code, Args&&... args) {
+        value_type* slot;
+        if (elements < values.capacity()) {
+            slot = values.data() + elements;
+            values.construct(slot, std::forward<Args>(args)...);
+        }
+        else {
+            value_type temp(std::forward<Args>(args)...);
+            values.grow(elements);
+            slot = values.data() + elements;
+            values.construct(slot, std::move(temp));
+        }
+        try {
+            link_back(code);
+        }
+        catch (...) {
+            anya::destroy_at(slot);
+            throw;
+        }
+        return begin() + (elements - 1);
+    }
+
+    // 把已经构造在末尾的元素链入桶中，需要时先扩容
+    void
+    link_back(size_t code) {
+        if (elements == compact_max_size) throw std::length_error("compact container exceeds 2^32 - 1 elements");
+        next.push_back(compact_npos);
+        if (is_overload(elements + 1, buckets.size())) {
+            try {
+                rebuild(RehashPolicy::next_bucket_count(std::ceil(static_cast<float>(elements + 1) / factor)), elements);
+            }
+            catch (...) {
+                next.pop_back();
+                throw;
+            }
+        }
+        size_t pos = RehashPolicy::index(code, buckets.size());
+        next[elements] = buckets[pos], buckets[pos] = static_cast<compact_index>(elements);
+        ++elements;
+    }
+
+    void
+    unlink(compact_index index, size_t pos) {
+        compact_index* link = &buckets[pos];
+        while (*link != index) link = &next[*link];
+        *link = next[index];
+    }
+
+    // 按新的桶数重新链接前 count 个元素，元素本身不移动；结点里没有哈希值，需要重新计算
+    void
+    rebuild(size_t new_bucket_size, size_t count) {
+        index_container temp(new_bucket_size, compact_npos);
+        for (size_t i = 0; i < count; ++i) {
+            size_t pos = RehashPolicy::index(hash_fcn(KeyPolicy::key(values[i])), new_bucket_size);
+            next[i] = temp[pos], temp[pos] = static_cast<compact_index>(i);
+        }
+        buckets.swap(temp);
+    }
+
+    void
+    rebuild(size_t new_bucket_size) { rebuild(new_bucket_size, elements); }
+
+    [[nodiscard]] bool
+    is_overload(size_t element_size, size_t bucket_size) const {
+        return static_cast<float>(element_size) > static_cast<float>(bucket_size) * factor;
+    }
+#pragma endregion
+
+
+#pragma region 友元比较函数
+public:
+    friend bool
+    operator==(const compact_hashtable& lhs, const compact_hashtable& rhs) {
+        if (lhs.size() != rhs.size()) return false;
+        for (auto& value : lhs) {
+            auto it = rhs.find(KeyPolicy::key(value));
+            if (it == rhs.end() || !(*it == value)) return false;
+        }
+        return true;
+    }
+#pragma endregion
+};
+
+template<class Key, class T, class Hash, class KeyEqual, class RehashPolicy, class KeyPolicy>
+void
+swap(compact_hashtable<Key, T, Hash, KeyEqual, RehashPolicy, KeyPolicy>& lhs,
+     compact_hashtable<Key, T, Hash, KeyEqual, RehashPolicy, KeyPolicy>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif //ANYA_STL_COMPACT_HASHTABLE_HPP
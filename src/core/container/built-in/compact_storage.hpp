@@ -0,0 +1,126 @@
+//
+// Created by Anya on 2023/8/27.
+//
+
+#ifndef ANYA_STL_COMPACT_STORAGE_HPP
+#define ANYA_STL_COMPACT_STORAGE_HPP
+
+#include "allocator/memory.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace anya {
+
+// 紧凑容器用32位下标代替指针连接结点，全1表示空链接
+using compact_index = uint32_t;
+
+constexpr compact_index compact_npos = ~compact_index(0);
+
+// 紧凑容器最多的元素个数，compact_npos 留作空链接
+constexpr size_t compact_max_size = compact_npos;
+
+// 紧凑容器的元素数组：一块连续的未初始化内存，只负责分配与扩容，元素的构造和析构由容器负责
+// 与 anya::vector 不同，元素不需要可以赋值，所以可以存放 pair<const Key, T>
+template<class T>
+class compact_storage {
+private:
+    T*                 items{};
+    size_t             capacity_{};
+    anya::allocator<T> alloc{};
+
+public:
+    compact_storage() = default;
+
+    compact_storage(const compact_storage&) = delete;
+
+    compact_storage(compact_storage&& other) noexcept
+        : items(std::exchange(other.items, nullptr)), capacity_(std::exchange(other.capacity_, 0)) {}
+
+    compact_storage&
+    operator=(compact_storage&& other) noexcept {
+        compact_storage(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    // 元素必须已经全部析构
+    ~compact_storage() { alloc.deallocate(items, capacity_); }
+
+    T*
+    data() noexcept { return items; }
+
+    const T*
+    data() const noexcept { return items; }
+
+    T&
+    operator[](size_t index) noexcept { return items[index]; }
+
+    const T&
+    operator[](size_t index) const noexcept { return items[index]; }
+
+    [[nodiscard]] size_t
+    capacity() const noexcept { return capacity_; }
+
+    // 在p处构造元素，p必须在 [data(), data() + capacity()) 内且未构造
+    template<class... Args>
+    void
+    construct(T* p, Args&&... args) { alloc.construct(p, std::forward<Args>(args)...); }
+
+    // 容量扩大到至少 n，前 live 个位置中 is_live(i) 为真的元素移动到新内存；
+    // 移动构造可能抛出异常时改为复制，失败时原数组不变
+    template<class Live = std::nullptr_t>
+    void
+    reserve(size_t n, size_t live, Live is_live = nullptr) {
+        if (n <= capacity_) return;
+        if (n > compact_max_size) throw std::length_error("compact container exceeds 2^32 - 1 elements");
+        constexpr bool all_live = std::is_same_v<Live, std::nullptr_t>;
+        T* fresh = alloc.allocate(n);
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (live) std::memcpy(static_cast<void*>(fresh), items, live * sizeof(T));
+        }
+        else {
+            size_t moved = 0;
+            try {
+                for (; moved < live; ++moved) {
+                    if constexpr (!all_live) if (!is_live(moved)) continue;
+                    alloc.construct(fresh + moved, std::move_if_noexcept(items[moved]));
+                }
+            }
+            catch (...) {
+                for (size_t i = 0; i < moved; ++i) {
+                    if constexpr (!all_live) if (!is_live(i)) continue;
+                    anya::destroy_at(fresh + i);
+                }
+                alloc.deallocate(fresh, n);
+                throw;
+            }
+            for (size_t i = 0; i < live; ++i) {
+                if constexpr (!all_live) if (!is_live(i)) continue;
+                anya::destroy_at(items + i);
+            }
+        }
+        alloc.deallocate(items, capacity_);
+        items = fresh, capacity_ = n;
+    }
+
+    // 满了时扩容一倍，至少16个
+    void
+    grow(size_t live) {
+        if (live < capacity_) return;
+        size_t doubled = capacity_ < 8 ? 16 : capacity_ * 2;
+        reserve(doubled > compact_max_size && live < compact_max_size ? compact_max_size : doubled, live);
+    }
+
+    void
+    swap(compact_storage& other) noexcept {
+        std::swap(items, other.items);
+        std::swap(capacity_, other.capacity_);
+    }
+};
+
+}
+
+#endif //ANYA_STL_COMPACT_STORAGE_HPP
@@ -0,0 +1,222 @@
+//
+// Created by Anya on 2023/8/2.
+//
+
+#ifndef ANYA_STL_HASH_POLICY_HPP
+#define ANYA_STL_HASH_POLICY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "functional/hash.hpp"
+
+namespace anya {
+
+#pragma region 哈希值缓存
+// 哈希函数是否足够廉价，廉价的哈希函数不需要在结点中缓存哈希值
+// 默认只有标量类型的 std::hash 和 anya::hash 被视为廉价，自定义哈希函数可以通过特化此模板来开关缓存
+template<class Hash>
+struct is_fast_hash : std::false_type {};
+
+template<class T>
+requires std::is_scalar_v<T>
+struct is_fast_hash<std::hash<T>> : std::true_type {};
+
+template<class T>
+requires std::is_scalar_v<T>
+struct is_fast_hash<anya::hash<T>> : std::true_type {};
+
+// 结点中的哈希值，不缓存时为空基类，不占用结点空间
+template<bool Cache>
+struct hash_code_storage {
+    size_t hash_code;
+};
+
+template<>
+struct hash_code_storage<false> {};
+#pragma endregion
+
+#pragma region 运行计数
+// 是否统计查找次数、探测步数、rehash次数和rehash耗时，默认由宏 ANYA_HASHTABLE_STATS 决定（默认关闭）
+// 也可以只为怀疑有问题的哈希函数特化此模板打开统计，关闭时计数器不占空间，计数的调用也全部编译为空
+#ifndef ANYA_HASHTABLE_STATS
+#  define ANYA_HASHTABLE_STATS 0
+#endif
+
+template<class Hash>
+struct hash_stats_enabled : std::bool_constant<ANYA_HASHTABLE_STATS != 0> {};
+
+// 计数器的快照
+struct hashtable_counters {
+    size_t lookups;        // 按key查找的次数，包括插入前的查重
+    size_t probes;         // 查找时比较过的结点数
+    size_t rehashes;       // 扩容的次数，渐进式rehash开始一次迁移算一次
+    size_t rehash_nanos;   // 花在 rehash 上的时间，包括渐进式rehash每一步的迁移
+};
+
+// 计数只用 relaxed 的读和写，不用读改写：共享读锁下多个读者同时计数时可能丢失少量增量，但不会有数据竞争，也不会争抢总线锁
+template<bool Enable>
+class hash_counter_storage {
+private:
+    std::atomic<size_t> lookups{}, probes{}, rehashes{}, rehash_nanos{};
+
+    static void
+    add(std::atomic<size_t>& counter, size_t n) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+public:
+    // 析构时把存活时间计入 rehash 耗时
+    class rehash_timer {
+    private:
+        hash_counter_storage& storage;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    public:
+        explicit rehash_timer(hash_counter_storage& storage) noexcept : storage(storage) {}
+
+        ~rehash_timer() {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            add(storage.rehash_nanos, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    };
+
+    void
+    lookup(size_t probe_count) noexcept { add(lookups, 1), add(probes, probe_count); }
+
+    void
+    rehash() noexcept { add(rehashes, 1); }
+
+    rehash_timer
+    time_rehash() noexcept { return rehash_timer(*this); }
+
+    [[nodiscard]] hashtable_counters
+    snapshot() const noexcept {
+        return {lookups.load(std::memory_order_relaxed), probes.load(std::memory_order_relaxed),
+                rehashes.load(std::memory_order_relaxed), rehash_nanos.load(std::memory_order_relaxed)};
+    }
+
+    void
+    reset() noexcept {
+        for (auto counter : {&lookups, &probes, &rehashes, &rehash_nanos}) counter->store(0, std::memory_order_relaxed);
+    }
+};
+
+template<>
+class hash_counter_storage<false> {
+public:
+    struct rehash_timer {};
+
+    void
+    lookup(size_t) noexcept {}
+
+    void
+    rehash() noexcept {}
+
+    rehash_timer
+    time_rehash() noexcept { return {}; }
+
+    [[nodiscard]] hashtable_counters
+    snapshot() const noexcept { return {}; }
+
+    void
+    reset() noexcept {}
+};
+#pragma endregion
+
+#pragma region 质数桶策略
+// 桶数取质数，下标为 hash % n
+// 每次定位都需要一次整数除法，但对质量较差的哈希函数（例如低位重复的哈希值）更宽容
+struct prime_rehash_policy {
+    constexpr static size_t number_of_primer = 28;
+    constexpr static size_t primers[number_of_primer] = {
+        53, 97, 193, 389,
+        769, 1543, 3079, 6151,
+        12289, 24593, 49157, 98317,
+        196613, 393241, 786433, 1572869,
+        3145739, 6291469, 12582917, 25165843,
+        50331653, 100663319, 201326611, 402653189,
+        805306457, 1610612741, 3221225473ul, 4294967291ul
+    };
+
+    // 获取不小于target的桶数
+    [[nodiscard]] constexpr static size_t
+    next_bucket_count(size_t target) {
+        auto finish = primers + number_of_primer;
+        auto it = std::lower_bound(primers, finish, target);
+        return it == finish ? *--finish : *it;
+    }
+
+    [[nodiscard]] constexpr static size_t
+    max_bucket_count() { return primers[number_of_primer - 1]; }
+
+    // 哈希值在n个桶中的下标
+    [[nodiscard]] constexpr static size_t
+    index(size_t code, size_t n) { return code % n; }
+};
+#pragma endregion
+
+#pragma region 2的幂桶策略
+// 桶数取2的幂，哈希值先乘以 2^64/φ 打散，再取乘积的高 log2(n) 位作为下标（Fibonacci hashing）
+// 高位受哈希值所有位的影响，所以即使 std::hash<int> 这种恒等哈希也能均匀分布，且定位只需一次乘法和移位
+struct power2_rehash_policy {
+    constexpr static size_t min_bucket_count = 16;
+    constexpr static size_t digits = std::numeric_limits<size_t>::digits;
+    constexpr static size_t golden = digits == 64 ? size_t(0x9E3779B97F4A7C15ull) : size_t(0x9E3779B9u);
+
+    // 获取不小于target的桶数
+    [[nodiscard]] constexpr static size_t
+    next_bucket_count(size_t target) {
+        if (target <= min_bucket_count) return min_bucket_count;
+        if (target >= max_bucket_count()) return max_bucket_count();
+        return std::bit_ceil(target);
+    }
+
+    [[nodiscard]] constexpr static size_t
+    max_bucket_count() { return size_t(1) << (digits - 1); }
+
+    // 哈希值在n个桶中的下标，n必须是2的幂且不小于2
+    [[nodiscard]] constexpr static size_t
+    index(size_t code, size_t n) {
+        return (code * golden) >> (digits - std::countr_zero(n));
+    }
+};
+#pragma endregion
+
+// 默认使用2的幂桶策略，若哈希函数质量很差可以换成 prime_rehash_policy
+using default_rehash_policy = power2_rehash_policy;
+
+#pragma region 键提取策略
+// 决定 hashtable 结点中存放什么，以及怎样从中取出key
+// 映射存放 pair<const Key, T>，key为first
+template<class Key, class T>
+struct map_key_policy {
+    using value_type = std::pair<const Key, T>;
+
+    constexpr static bool is_map = true;
+
+    [[nodiscard]] constexpr static const Key&
+    key(const value_type& value) noexcept { return value.first; }
+};
+
+// 集合只存放key本身，结点不再为T浪费空间
+template<class Key>
+struct set_key_policy {
+    using value_type = Key;
+
+    constexpr static bool is_map = false;
+
+    [[nodiscard]] constexpr static const Key&
+    key(const value_type& value) noexcept { return value; }
+};
+#pragma endregion
+
+}
+
+#endif //ANYA_STL_HASH_POLICY_HPP
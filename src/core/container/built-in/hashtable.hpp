@@ -6,23 +6,51 @@
 #define ANYA_STL_HASHTABLE_HPP
 
 #include "container/vector.hpp"
+#include "container/built-in/hash_policy.hpp"
+#include "allocator/node_slab.hpp"
 #include "iterator/iterator.hpp"
+#include "thread/thread_pool.hpp"
+#include <cmath>
+#include <tuple>
 
 namespace anya {
 
+// 桶的整体状况，由 hashtable::statistics() 遍历所有桶得到
+struct hashtable_statistics {
+    size_t               size;            // 元素个数
+    size_t               bucket_count;    // 参与统计的桶数，渐进式rehash期间包括还没迁移的旧桶
+    size_t               empty_buckets;   // 空桶的个数
+    size_t               longest_chain;   // 最长的链
+    float                load_factor;     // 元素个数 / 桶数，没有桶时为0
+    float                empty_ratio;     // 空桶 / 桶数，没有桶时为0
+    anya::vector<size_t> histogram;       // histogram[i] 为链长为i的桶数，最后一格统计链长不小于它的桶
+};
+
 template<
     class Key,
     class T,
-    class Hash      = std::hash<Key>,
+    class Hash      = anya::hash<Key>,
     class KeyEqual  = std::equal_to<Key>,
-    class Allocator = anya::allocator<std::pair<const Key, T>>>
+    class Allocator = anya::allocator<std::pair<const Key, T>>,
+    class RehashPolicy = anya::default_rehash_policy,
+    class KeyPolicy = anya::map_key_policy<Key, T>>
 class hashtable {
 #pragma region 迭代器实现
 private:
+    // 哈希函数代价较高时在结点中缓存完整的哈希值，rehash时无需重新计算，查找时也能先比较哈希值再比较key
+    constexpr static bool cache_hash_code = !anya::is_fast_hash<Hash>::value;
+
+    // 集合的T没有意义，结点只存放key
+    constexpr static bool is_map = KeyPolicy::is_map;
+
+    // 把 Allocator 重新绑定到其他类型，结点、桶数组与元素都使用同一个底层配置器
+    template<class U>
+    using rebind_alloc = typename Allocator::template rebind<U>::other;
+
     // 开链法结点
-    struct bucket_node {
+    struct bucket_node : anya::hash_code_storage<cache_hash_code> {
         bucket_node* next;
-        std::pair<const Key, T> value;
+        typename KeyPolicy::value_type value;
     };
 
 private:
@@ -34,6 +62,7 @@ private:
 
     private:
         bucket_node* current;   // 迭代器当前位置
+        size_t bucket;          // 当前结点所在的桶，避免自增到链尾时重新计算哈希
         const hashtable* table; // 所属的容器
 
     public:
@@ -43,17 +72,17 @@ private:
         using difference_type = typename hashtable_iterator::difference_type;
 
     public:
-        hashtable_iterator(bucket_node* node, const hashtable* belong)
-            : current(node), table(belong) {}
+        hashtable_iterator(bucket_node* node, size_t index, const hashtable* belong)
+            : current(node), bucket(index), table(belong) {}
 
         hashtable_iterator() = default;
 
         hashtable_iterator(const hashtable_iterator&) = default;
 
         template<typename U>
-        requires std::same_as<U, std::pair<const Key, T>>
+        requires std::same_as<U, typename KeyPolicy::value_type>
         hashtable_iterator(const hashtable_iterator<U>& other)
-            noexcept: current(other.current), table(other.table) {}
+            noexcept: current(other.current), bucket(other.bucket), table(other.table) {}
 
     public:
         reference
@@ -64,7 +93,7 @@ private:
 
         hashtable_iterator&
         operator++() {
-            current = table->next_node(current); return *this;
+            table->next_node(current, bucket); return *this;
         }
 
         hashtable_iterator
@@ -86,47 +115,146 @@ private:
     };
 #pragma endregion
 
+#pragma region 结点句柄实现
+private:
+    // 持有一个从表中摘下的结点，可以修改key后重新插入本表或同类型的其他表，整个过程不会重新分配内存
+    class node_handle {
+    private:
+        friend class hashtable;
+
+        bucket_node* node = nullptr;
+
+        explicit node_handle(bucket_node* ptr) noexcept : node(ptr) {}
+
+    public:
+        using key_type       = Key;
+        using mapped_type    = T;
+        using value_type     = typename KeyPolicy::value_type;
+        using allocator_type = rebind_alloc<value_type>;
+
+    public:
+        node_handle() noexcept = default;
+
+        node_handle(const node_handle&) = delete;
+
+        node_handle(node_handle&& other) noexcept : node(other.node) { other.node = nullptr; }
+
+        node_handle&
+        operator=(node_handle&& other) noexcept {
+            if (this != &other) reset(), node = other.node, other.node = nullptr;
+            return *this;
+        }
+
+        ~node_handle() { reset(); }
+
+    public:
+        [[nodiscard]] bool
+        empty() const noexcept { return node == nullptr; }
+
+        explicit operator bool() const noexcept { return node != nullptr; }
+
+        // 与标准库相同，允许在结点脱离容器期间修改key
+        key_type&
+        key() const requires is_map { return const_cast<key_type&>(node->value.first); }
+
+        mapped_type&
+        mapped() const requires is_map { return node->value.second; }
+
+        // 集合的结点句柄通过value访问元素
+        value_type&
+        value() const requires (!is_map) { return node->value; }
+
+        [[nodiscard]] allocator_type
+        get_allocator() const { return allocator_type(); }
+
+        void
+        swap(node_handle& other) noexcept { std::swap(node, other.node); }
+
+    private:
+        // 放弃所有权
+        bucket_node*
+        release() noexcept {
+            bucket_node* ptr = node;
+            node = nullptr;
+            return ptr;
+        }
+
+        void
+        reset() {
+            if (node == nullptr) return;
+            allocator_type().destroy(std::addressof(node->value));
+            rebind_alloc<bucket_node>().deallocate(node, 1);
+            node = nullptr;
+        }
+    };
+#pragma endregion
+
 public:
     using key_type        = Key;
     using mapped_type     = T;
-    using value_type      = std::pair<const Key, T>;
+    using value_type      = typename KeyPolicy::value_type;
     using size_type       = size_t;
     using difference_type = ptrdiff_t;
     using hasher          = Hash;
     using key_equal       = KeyEqual;
-    using allocator_type  = anya::allocator<std::pair<const Key, T>>;
+    using rehash_policy   = RehashPolicy;
+    using allocator_type  = rebind_alloc<value_type>;
     using reference       = value_type&;
     using const_reference = const value_type&;
     using pointer         = value_type*;
     using const_pointer   = const value_type*;
     using iterator        = hashtable_iterator<value_type>;
     using const_iterator  = hashtable_iterator<const value_type>;
+    using node_type       = node_handle;
+
+    struct insert_return_type {
+        iterator  position;
+        bool      inserted;
+        node_type node;
+    };
+
+    // 哈希函数与比较函数都声明了 is_transparent 时，查找接口接受任何能与Key比较的类型，不需要构造临时的Key
+    constexpr static bool is_transparent = requires {
+        typename Hash::is_transparent;
+        typename KeyEqual::is_transparent;
+    };
+
+    template<class K>
+    constexpr static bool transparent_key = is_transparent
+        && !std::is_convertible_v<K, iterator>
+        && !std::is_convertible_v<K, const_iterator>;
 
 private:
-    using bucket_container = anya::vector<bucket_node*>;
-    using node_alloc_type  = anya::allocator<bucket_node>;
+    using bucket_container = anya::vector<bucket_node*, rebind_alloc<bucket_node*>>;
+    using node_alloc_type  = anya::node_allocator_t<Allocator, bucket_node>;
+
+    // Allocator 为 slab_allocator 时结点来自本表私有的 node_slab，结点不能转移到其他表
+    constexpr static bool slab_nodes = anya::is_slab_allocator<Allocator>::value;
 
     allocator_type  default_alloc{};      // 普通内存分配器
-    node_alloc_type bucket_node_alloc{};  // bucket_node 内存分配器
+    node_alloc_type bucket_node_alloc{};  // bucket_node 内存分配器，可能是私有的结点池
 
     hasher           hash_fcn{};   // 哈希函数
     key_equal        equal_fcn{};  // 比较函数
     bucket_container buckets{};    // 桶数组
     size_t           elements{};   // 元素数量
+    size_t           first{};      // 第一个非空桶的下标，表为空时等于桶的个数
     float            factor = 1;   // 装置因子
+    float            min_factor = 0.125f;  // 装载因子下限，低于它时缩小桶数组，为0时不自动缩小
+    bool             shrink_pending{};     // 删除后欠载，为了不让其他迭代器失效，等下一次插入时再缩小
+
+    // 渐进式rehash：扩容时旧桶数组保留在 old_buckets 中，之后每次插入只迁移 rehash_step 个旧桶
+    // 迁移期间的桶下标统一编号，[0, old_buckets.size()) 指向旧桶，之后的下标指向新桶
+    // 旧桶中下标小于 rehash_index 的都已经迁移完毕，为空
+    bucket_container old_buckets{};   // 正在迁移的旧桶数组，不在迁移时为空
+    size_t           rehash_index{};  // 下一个要迁移的旧桶
+    size_t           rehash_step{};   // 每次插入迁移的旧桶个数，为0时一次性rehash
+
+    // 运行计数，只在 hash_stats_enabled<Hash> 为真时存在
+    [[no_unique_address]] mutable hash_counter_storage<hash_stats_enabled<Hash>::value> counter{};
 
-    // 桶的个数，以及备用质数表
+    // 默认桶的个数，实际个数由 RehashPolicy 取整
     constexpr static size_t default_size = 11;
-    constexpr static size_t number_of_primer = 28;
-    constexpr static size_t primers[number_of_primer] = {
-        53, 97, 193, 389,
-        769, 1543, 3079, 6151,
-        12289, 24593, 49157, 98317,
-        196613, 393241, 786433, 1572869,
-        3145739, 6291469, 12582917, 25165843,
-        50331653, 100663319, 201326611, 402653189,
-        805306457, 1610612741, 3221225473ul, 4294967291ul
-    };
 
 #pragma region 构造 && 析构
 public:
@@ -135,7 +263,9 @@ public:
     explicit hashtable(size_t bucket_count,
                        const hasher& hash = hasher(),
                        const key_equal& equal = key_equal())
-        : hash_fcn(hash), equal_fcn(equal), buckets(bucket_count, nullptr)
+        : hash_fcn(hash), equal_fcn(equal),
+          buckets(RehashPolicy::next_bucket_count(bucket_count), nullptr),
+          first(buckets.size())
     {}
 
     hashtable(const hashtable& other) {
@@ -143,10 +273,15 @@ public:
     }
 
     hashtable(hashtable&& other) noexcept:
-        buckets(std::move(other.buckets)),
         hash_fcn(std::move(other.hash_fcn)),
-        equal_fcn(std::move(other.equal_fcn)) {
+        equal_fcn(std::move(other.equal_fcn)),
+        buckets(std::move(other.buckets)),
+        old_buckets(std::move(other.old_buckets)) {
+        std::swap(bucket_node_alloc, other.bucket_node_alloc);
         elements = other.elements, other.elements = 0;
+        first = other.first, other.first = 0;
+        factor = other.factor, min_factor = other.min_factor, shrink_pending = other.shrink_pending;
+        rehash_index = other.rehash_index, rehash_step = other.rehash_step;
     }
 
     ~hashtable() { destroy_all(); }
@@ -164,8 +299,14 @@ public:
     hashtable&
     operator=(hashtable&& other) noexcept {
         if (&other == this) return *this;
+        destroy_all();
+        std::swap(bucket_node_alloc, other.bucket_node_alloc);
         buckets = std::move(other.buckets);
+        old_buckets = std::move(other.old_buckets);
         elements = other.elements, other.elements = 0;
+        first = other.first, other.first = 0;
+        factor = other.factor, min_factor = other.min_factor, shrink_pending = other.shrink_pending;
+        rehash_index = other.rehash_index, rehash_step = other.rehash_step;
         hash_fcn = std::move(other.hash_fcn), equal_fcn = std::move(other.equal_fcn);
         return *this;
     }
@@ -178,22 +319,22 @@ public:
 #pragma region 迭代器
 public:
     iterator
-    begin() noexcept { return iterator{first_bucket(), this}; }
+    begin() noexcept { return iterator(first_bucket(), first, this); }
 
     const_iterator
-    begin() const noexcept { return const_iterator(first_bucket(), this); }
+    begin() const noexcept { return const_iterator(first_bucket(), first, this); }
 
     const_iterator
-    cbegin() const noexcept { return const_iterator(first_bucket(), this); }
+    cbegin() const noexcept { return const_iterator(first_bucket(), first, this); }
 
     iterator
-    end() noexcept { return iterator(nullptr, this); }
+    end() noexcept { return iterator(nullptr, bucket_end(), this); }
 
     const_iterator
-    end() const noexcept { return const_iterator(nullptr, this); }
+    end() const noexcept { return const_iterator(nullptr, bucket_end(), this); }
 
     const_iterator
-    cend() const noexcept { return const_iterator(nullptr, this); }
+    cend() const noexcept { return const_iterator(nullptr, bucket_end(), this); }
 #pragma endregion
 
 
@@ -215,100 +356,261 @@ public:
     void
     clear() { destroy_all(); }
 
-    // 设置为合适的size
+    // 设置为合适的size，总是一次性完成rehash
     void
     resize(size_t hint_elements) {
-        size_t bucket_size = buckets.size();
-        if (is_overload(hint_elements, bucket_size) == false) return;
-        size_t new_bucket_size = next_primer(hint_elements);
-        bucket_container temp(new_bucket_size, nullptr);
-        bucket_node* next;
-        for (bucket_node* ptr : this->buckets) {
-            while (ptr) {
-                size_t new_index = bucket_index(ptr->value.first, new_bucket_size);
-                next = ptr->next;
-                insert_head(temp[new_index], ptr);
-                ptr = next;
-            }
-        }
-        buckets.swap(temp);
+        if (is_overload(hint_elements, buckets.size()) == false) return;
+        rebuild(RehashPolicy::next_bucket_count(hint_elements));
     }
 
+    // 缩小到能以 max_load_factor 容纳现有元素的最少桶数，释放多余的桶数组
+    void
+    shrink_to_fit() { rehash(0); }
+
+    // 设置渐进式rehash每次插入迁移的桶数，为0时关闭（默认），扩容时一次性迁移所有结点
+    // 开启后单次插入的最坏耗时不再与元素数量成正比，代价是迁移期间查找可能需要多判断一次旧桶
+    void
+    incremental_rehash(size_t step) {
+        rehash_step = step;
+        if (step == 0) finish_rehash();
+    }
+
+    [[nodiscard]] size_t
+    incremental_rehash() const noexcept { return rehash_step; }
+
+    // 是否正在进行渐进式rehash
+    [[nodiscard]] bool
+    rehashing() const noexcept { return !old_buckets.empty(); }
+
     // 不可重复置入
+    // 能直接从参数中取出key时先查找，key已存在就不会构造任何对象；否则先构造结点再查找
     template<class... Args>
     std::pair<iterator, bool>
     emplace_unique(Args&&... args) {
-        resize(this->elements + 1);
-        return insert_unique(value_type(std::forward<Args>(args)...));
+        if constexpr (extractable_key<Args...>()) {
+            const Key& key = extract_key(args...);
+            size_t code = hash_fcn(key), pos = locate(code);
+            if (bucket_node* exist = find_by_key(key, code, pos)) return {iterator(exist, pos, this), false};
+            return {insert_unique_node(make_node(std::forward<Args>(args)...), code), true};
+        }
+        else {
+            bucket_node* node = make_node(std::forward<Args>(args)...);
+            size_t code = hash_fcn(node_key(node)), pos = locate(code);
+            if (bucket_node* exist = find_by_key(node_key(node), code, pos)) {
+                destroy_node(node);
+                return {iterator(exist, pos, this), false};
+            }
+            return {insert_unique_node(node, code), true};
+        }
     }
 
     // 可重复置入
     template<class... Args>
     std::pair<iterator, bool>
     emplace_multi(Args&&... args) {
-        resize(this->elements + 1);
-        return insert_multi(value_type(std::forward<Args>(args)...));
+        bucket_node* node = make_node(std::forward<Args>(args)...);
+        return {insert_multi_node(node, hash_fcn(node_key(node))), true};
+    }
+
+    // key不存在时才以 (key, args...) 原位构造元素，key存在时args不会被移动
+    template<class K, class... Args>
+    requires std::same_as<std::remove_cvref_t<K>, Key>
+    std::pair<iterator, bool>
+    try_emplace(K&& key, Args&&... args) {
+        size_t code = hash_fcn(key), pos = locate(code);
+        if (bucket_node* exist = find_by_key(key, code, pos)) return {iterator(exist, pos, this), false};
+        bucket_node* node = make_node(std::piecewise_construct,
+                                      std::forward_as_tuple(std::forward<K>(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+        return {insert_unique_node(node, code), true};
+    }
+
+    // key存在时赋值，不存在时插入
+    template<class K, class M>
+    requires std::same_as<std::remove_cvref_t<K>, Key>
+    std::pair<iterator, bool>
+    insert_or_assign(K&& key, M&& obj) {
+        size_t code = hash_fcn(key), pos = locate(code);
+        if (bucket_node* exist = find_by_key(key, code, pos)) {
+            exist->value.second = std::forward<M>(obj);
+            return {iterator(exist, pos, this), false};
+        }
+        bucket_node* node = make_node(std::forward<K>(key), std::forward<M>(obj));
+        return {insert_unique_node(node, code), true};
     }
 
     iterator
     erase(const_iterator pos) {
-        size_t index = bucket_index(pos->first);
-        bucket_node* current = buckets[index];
+        size_t index = pos.bucket;
+        bucket_node* current = bucket_at(index);
         bucket_node* ptr = pos.current, *next = ptr->next, *pre = nullptr;
         while (current != ptr) pre = current, current = current->next;
         connect_next(pre, next, index);
         destroy_node(current);
-        return {next, this};
+        update_first();
+        shrink_pending = true;
+        if (next == nullptr) next_node(next, index);
+        return {next, index, this};
     }
 
     iterator
     erase(const_iterator first, const_iterator last) {
-        if (first == last) return {last.current, this};
-        size_t index = bucket_index(first->first), buckets_size = buckets.size();
-        bucket_node* current = buckets[index];
-        bucket_node* pre = nullptr, *next = nullptr;
+        if (first == last) return {last.current, last.bucket, this};
+        size_t index = first.bucket;
+        bucket_node* current = bucket_at(index);
+        bucket_node* pre = nullptr;
         bucket_node* start = first.current, *finish = last.current;
-        // 找到第一个迭代器的前驱
+        // 找到第一个迭代器的前驱，之后的结点都是整段删除，不需要再找前驱
         while (current != start) pre = current, current = current->next;
-        while (true) {
-            next = current->next, destroy_node(current);
+        while (current != finish) {
+            bucket_node* next = current->next;
+            destroy_node(current);
             current = next;
             // 需要跨越bucket
             if (current == nullptr) {
-                connect_next(pre, next, index), pre = nullptr;
-                while (!current && ++index < buckets_size) current = buckets[index];
-            }
-            if (current == finish) {
-                if (finish) connect_next(pre, next, index);
-                break;
+                connect_next(pre, nullptr, index), pre = nullptr;
+                next_node(current, index);
             }
         }
-        return {last.current, this};
+        if (finish) connect_next(pre, finish, index);
+        update_first();
+        shrink_pending = true;
+        return {last.current, last.bucket, this};
     }
 
+    // 批量不重复插入 [first, last) 中的元素，返回实际插入的个数
+    // 先按元素个数一次性扩容，保证插入过程中桶下标不变，再像 find_batch 一样流水线预取
+    template<class ForwardIt>
     size_type
-    erase(const Key& key) {
-        size_t index = bucket_index(key), cnt = 0;
-        bucket_node* current = buckets[index];
-        bucket_node* pre = nullptr, *next = nullptr;
-        while (current && !equal_fcn(current->value.first, key))
-            pre = current, current = current->next;
-        // 因为相同的值肯定在同一个哈希桶里，所以这里可以直接返回
-        if (!current) return 0;
-        do {
-            next = current->next, destroy_node(current);
-            current = next, ++cnt;
-        } while (current && equal_fcn(current->value.first, key));
-        (pre ? pre->next : buckets[index]) = current;
-        return cnt;
+    insert_batch(ForwardIt first, ForwardIt last) {
+        size_t count = 0, inserted = 0;
+        for (auto it = first; it != last; ++it) ++count;
+        reserve(this->elements + count);
+        pipeline_batch(first, last, value_key, [this, &inserted](ForwardIt it, size_t code, size_t pos) {
+            if (find_by_key(value_key(*it), code, pos)) return;
+            bucket_node* node = make_node(*it);
+            store_hash_code(node, code);
+            insert_head(bucket_at(pos), node);
+            this->first = anya::min(this->first, pos);
+            ++inserted;
+        });
+        return inserted;
+    }
+
+    // 把pos处的结点从表中摘下，不释放内存
+    node_type
+    extract(const_iterator pos) requires (!slab_nodes) {
+        size_t index = pos.bucket;
+        bucket_node* current = bucket_at(index), *pre = nullptr;
+        while (current != pos.current) pre = current, current = current->next;
+        connect_next(pre, current->next, index);
+        --this->elements;
+        update_first();
+        shrink_pending = true;
+        return node_type(current);
+    }
+
+    node_type
+    extract(const Key& key) requires (!slab_nodes) { return extract_by_key(key); }
+
+    template<class K>
+    requires (transparent_key<K> && !slab_nodes)
+    node_type
+    extract(K&& key) { return extract_by_key(key); }
+
+    // 不重复地插入结点句柄持有的结点，key已存在时结点留在返回值的 node 中
+    insert_return_type
+    insert_unique(node_type&& handle) requires (!slab_nodes) {
+        if (handle.empty()) return {end(), false, node_type()};
+        const Key& key = node_key(handle.node);
+        size_t code = hash_fcn(key), pos = locate(code);
+        if (bucket_node* exist = find_by_key(key, code, pos)) return {iterator(exist, pos, this), false, std::move(handle)};
+        ++this->elements;
+        return {insert_unique_node(handle.release(), code), true, node_type()};
+    }
+
+    iterator
+    insert_multi(node_type&& handle) requires (!slab_nodes) {
+        if (handle.empty()) return end();
+        size_t code = hash_fcn(node_key(handle.node));
+        ++this->elements;
+        return insert_multi_node(handle.release(), code);
+    }
+
+    // 把source中key在本表中不存在的结点逐个摘下并接入本表，不分配也不释放内存
+    // 哈希函数无状态时两张表的哈希值一致，直接沿用source缓存的哈希值
+    void
+    merge_unique(hashtable& source) requires (!slab_nodes) {
+        if (&source == this) return;
+        for (auto it = source.begin(), last = source.end(); it != last;) {
+            auto pos = it++;
+            size_t code = std::is_empty_v<Hash> ? source.node_hash_code(pos.current) : hash_fcn(node_key(pos.current));
+            if (find_by_key(node_key(pos.current), code, locate(code))) continue;
+            bucket_node* node = source.extract(pos).release();
+            ++this->elements;
+            insert_unique_node(node, code);
+        }
+    }
+
+    // 把source中的结点全部摘下并接入本表
+    void
+    merge_multi(hashtable& source) requires (!slab_nodes) {
+        if (&source == this) return;
+        for (auto it = source.begin(), last = source.end(); it != last;) {
+            auto pos = it++;
+            size_t code = std::is_empty_v<Hash> ? source.node_hash_code(pos.current) : hash_fcn(node_key(pos.current));
+            bucket_node* node = source.extract(pos).release();
+            ++this->elements;
+            insert_multi_node(node, code);
+        }
+    }
+
+    size_type
+    erase(const Key& key) { return erase_by_key(key); }
+
+    template<class K>
+    requires transparent_key<K>
+    size_type
+    erase(K&& key) { return erase_by_key(key); }
+
+    // 删除所有满足 pred 的元素，返回删除的个数；删除后欠载时与按key删除一样，等下一次插入时再缩小
+    // 逐个桶沿链表遍历，边走边记住前驱的链接，摘除结点时不需要像 erase(iterator) 那样从桶头重新查找前驱
+    template<class UnaryPredicate>
+    size_type
+    erase_if(UnaryPredicate pred) {
+        size_t before = this->elements, buckets_size = bucket_end();
+        try {
+            for (size_t index = first; index < buckets_size; ++index) {
+                bucket_node** link = &bucket_at(index);
+                while (bucket_node* current = *link) {
+                    if (pred(std::as_const(current->value))) *link = current->next, destroy_node(current);
+                    else link = &current->next;
+                }
+            }
+        }
+        catch (...) {
+            update_first();
+            throw;
+        }
+        update_first();
+        shrink_pending = true;
+        return before - this->elements;
     }
 
     void
     swap(hashtable& other) noexcept {
         buckets.swap(other.buckets);
+        old_buckets.swap(other.old_buckets);
+        std::swap(this->rehash_index, other.rehash_index);
+        std::swap(this->rehash_step, other.rehash_step);
+        std::swap(this->factor, other.factor);
+        std::swap(this->min_factor, other.min_factor);
+        std::swap(this->shrink_pending, other.shrink_pending);
         std::swap(this->elements, other.elements);
+        std::swap(this->first, other.first);
         std::swap(this->hash_fcn, other.hash_fcn);
         std::swap(this->equal_fcn, other.equal_fcn);
+        std::swap(this->bucket_node_alloc, other.bucket_node_alloc);
     }
 #pragma endregion
 
@@ -316,43 +618,107 @@ public:
 #pragma region 查找
 public:
     [[nodiscard]] size_t
-    count(const Key& key) const {
-        size_t cnt = 0, pos = bucket_index(key);
-        bucket_node* current = buckets[pos];
-        while (current && !equal_fcn(current->value.first, key))
-            current = current->next;
-        while (current && equal_fcn(current->value.first, key))
-            current = current->next, ++cnt;
-        return cnt;
+    count(const Key& key) const { return count_by_key(key); }
+
+    template<class K>
+    requires transparent_key<K>
+    [[nodiscard]] size_t
+    count(const K& key) const { return count_by_key(key); }
+
+    iterator
+    find(const Key& key) {
+        auto [node, pos] = find_position(key);
+        return {node, pos, this};
+    }
+
+    const_iterator
+    find(const Key& key) const {
+        auto [node, pos] = find_position(key);
+        return {node, pos, this};
     }
 
+    template<class K>
+    requires transparent_key<K>
     iterator
-    find(const Key& key) { return {find_by_key(key), this}; }
+    find(const K& key) {
+        auto [node, pos] = find_position(key);
+        return {node, pos, this};
+    }
 
+    template<class K>
+    requires transparent_key<K>
     const_iterator
-    find(const Key& key) const { return {find_by_key(key), this}; }
+    find(const K& key) const {
+        auto [node, pos] = find_position(key);
+        return {node, pos, this};
+    }
 
     std::pair<iterator, iterator>
     equal_range(const Key& key) {
-        auto tmp = find_range_by_key(key);
-        return {{tmp.first,  this}, {tmp.second, this}};
+        auto [start, finish] = equal_range_position(key);
+        return {{start.first, start.second, this}, {finish.first, finish.second, this}};
     }
 
     [[nodiscard]] std::pair<const_iterator, const_iterator>
     equal_range(const Key& key) const {
-        auto tmp = find_range_by_key(key);
-        return {{tmp.first,  this}, {tmp.second, this}};
+        auto [start, finish] = equal_range_position(key);
+        return {{start.first, start.second, this}, {finish.first, finish.second, this}};
+    }
+
+    template<class K>
+    requires transparent_key<K>
+    std::pair<iterator, iterator>
+    equal_range(const K& key) {
+        auto [start, finish] = equal_range_position(key);
+        return {{start.first, start.second, this}, {finish.first, finish.second, this}};
+    }
+
+    template<class K>
+    requires transparent_key<K>
+    [[nodiscard]] std::pair<const_iterator, const_iterator>
+    equal_range(const K& key) const {
+        auto [start, finish] = equal_range_position(key);
+        return {{start.first, start.second, this}, {finish.first, finish.second, this}};
+    }
+
+    // 批量查找 [first, last) 中的每个key，依次把结果迭代器（找不到时为end()）写入result
+    // 按组流水线执行：计算一组的哈希并预取桶的同时，预取上一组的链表头结点、比较再上一组的key，访存延迟互相重叠
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    find_batch(ForwardIt first, ForwardIt last, OutputIt result) {
+        lookup_batch(first, last, [this, &result](bucket_node* node, size_t pos) {
+            *result++ = node ? iterator(node, pos, this) : end();
+        });
+        return result;
+    }
+
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    find_batch(ForwardIt first, ForwardIt last, OutputIt result) const {
+        lookup_batch(first, last, [this, &result](bucket_node* node, size_t pos) {
+            *result++ = node ? const_iterator(node, pos, this) : end();
+        });
+        return result;
+    }
+
+    // 批量判断 [first, last) 中的每个key是否存在，依次把结果写入result
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    contains_batch(ForwardIt first, ForwardIt last, OutputIt result) const {
+        lookup_batch(first, last, [&result](bucket_node* node, size_t) { *result++ = node != nullptr; });
+        return result;
     }
 #pragma endregion
 
 
 #pragma region 桶接口
 public:
+    // 渐进式rehash期间桶接口只反映新桶数组
     [[nodiscard]] size_type
     bucket_count() const { return buckets.size(); }
 
     [[nodiscard]] size_type
-    max_bucket_count() const { return primers[number_of_primer - 1]; }
+    max_bucket_count() const { return RehashPolicy::max_bucket_count(); }
 
     [[nodiscard]] size_type
     bucket_size(size_type n) const {
@@ -364,13 +730,18 @@ public:
 
     [[nodiscard]] size_type
     bucket(const Key& key) const { return bucket_index(key); }
+
+    template<class K>
+    requires transparent_key<K>
+    [[nodiscard]] size_type
+    bucket(const K& key) const { return bucket_index(key); }
 #pragma endregion
 
 
 #pragma region 哈希策略
 public:
     [[nodiscard]] float
-    load_factor() const { return size() / bucket_count(); }
+    load_factor() const { return static_cast<float>(size()) / bucket_count(); }
 
     [[nodiscard]] float
     max_load_factor() const { return factor; }
@@ -378,11 +749,103 @@ public:
     void
     max_load_factor(float ml) { factor = ml; }
 
+    // 装载因子下限，为0时关闭自动缩容
+    [[nodiscard]] float
+    min_load_factor() const { return min_factor; }
+
     void
-    rehash(size_type count) { resize(count); }
+    min_load_factor(float ml) { min_factor = ml; }
+
+    // 桶数设为不小于count、且能以 max_load_factor 容纳现有元素的最小值，可能扩大也可能缩小，总是一次性完成
+    void
+    rehash(size_type count) {
+        size_t needed = std::ceil(static_cast<float>(size()) / max_load_factor());
+        size_t new_bucket_size = RehashPolicy::next_bucket_count(anya::max(count, needed));
+        if (new_bucket_size != buckets.size() || rehashing()) rebuild(new_bucket_size);
+    }
 
+    // 只扩大，不会因为count小于现有桶数而缩小
     void
-    reserve(size_type count) { rehash(std::ceil(static_cast<float>(count) / max_load_factor())); }
+    reserve(size_type count) {
+        if (is_overload(count, buckets.size())) rehash(std::ceil(static_cast<float>(count) / max_load_factor()));
+    }
+#pragma endregion
+
+
+#pragma region 并行操作
+public:
+    // 把 [first, last) 分成 threads 段，在线程池 pool 上不重复插入，返回实际插入的个数；
+    // threads 为0时取 pool 的大小，元素太少时退化为逐个插入
+    // 重复的key保留输入中最先出现的一个；迭代器需要支持随机访问，元素的构造、哈希与比较会在多个线程中同时调用
+    // 结点的内存由调用线程分配和回收，元素的构造本身需要能在多个线程中同时进行
+    // 构造元素抛出异常时还没链入的结点全部回收，已插入的保留
+    template<class RandomIt>
+    size_type
+    insert_parallel_unique(RandomIt first, RandomIt last, size_t threads = 0, thread_pool& pool = default_thread_pool()) {
+        return insert_parallel<true>(first, last, threads, pool);
+    }
+
+    // 可重复的并行插入，相同的key仍然相邻
+    template<class RandomIt>
+    size_type
+    insert_parallel_multi(RandomIt first, RandomIt last, size_t threads = 0, thread_pool& pool = default_thread_pool()) {
+        return insert_parallel<false>(first, last, threads, pool);
+    }
+
+    // 与 rehash(count) 相同，结点的重新分配分成 threads 段在线程池 pool 上完成，threads 为0时取 pool 的大小
+    void
+    rehash(size_type count, size_t threads, thread_pool& pool = default_thread_pool()) {
+        size_t needed = std::ceil(static_cast<float>(size()) / max_load_factor());
+        size_t new_bucket_size = RehashPolicy::next_bucket_count(anya::max(count, needed));
+        if (new_bucket_size != buckets.size() || rehashing()) rebuild(new_bucket_size, threads, pool);
+    }
+
+    void
+    reserve(size_type count, size_t threads, thread_pool& pool = default_thread_pool()) {
+        if (is_overload(count, buckets.size())) {
+            rehash(std::ceil(static_cast<float>(count) / max_load_factor()), threads, pool);
+        }
+    }
+
+    // 把桶数组平均切成至多 parts 段，返回每段的迭代器对，各段首尾相接，依次遍历正好是 [begin(), end())，空段被省略
+    // 各段互不相交，可以交给不同的线程同时遍历，遍历期间不能插入或删除元素
+    anya::vector<std::pair<iterator, iterator>>
+    split(size_t parts) { return split_ranges<iterator>(parts); }
+
+    anya::vector<std::pair<const_iterator, const_iterator>>
+    split(size_t parts) const { return split_ranges<const_iterator>(parts); }
+#pragma endregion
+
+
+#pragma region 统计
+public:
+    // 遍历所有桶统计链长分布，O(桶数 + 元素数)；链长不小于 max_chain 的桶都计入 histogram 的最后一格
+    // 渐进式rehash期间统计新桶和还没迁移的旧桶，已经迁移完的旧桶不计入
+    [[nodiscard]] hashtable_statistics
+    statistics(size_t max_chain = 16) const {
+        hashtable_statistics result{};
+        result.size = this->elements;
+        result.histogram.resize(anya::max(max_chain, size_t(1)) + 1, 0);
+        for (size_t i = rehash_index; i < bucket_end(); ++i) {
+            size_t length = 0;
+            for (bucket_node* current = bucket_at(i); current; current = current->next) ++length;
+            ++result.bucket_count;
+            result.empty_buckets += length == 0;
+            result.longest_chain = anya::max(result.longest_chain, length);
+            ++result.histogram[anya::min(length, result.histogram.size() - 1)];
+        }
+        float buckets_count = static_cast<float>(result.bucket_count);
+        result.load_factor = result.bucket_count ? static_cast<float>(result.size) / buckets_count : 0;
+        result.empty_ratio = result.bucket_count ? static_cast<float>(result.empty_buckets) / buckets_count : 0;
+        return result;
+    }
+
+    // 查找、探测、rehash 的计数，未开启 hash_stats_enabled<Hash> 时全为0
+    [[nodiscard]] hashtable_counters
+    counters() const noexcept { return counter.snapshot(); }
+
+    void
+    reset_counters() noexcept { counter.reset(); }
 #pragma endregion
 
 
@@ -417,58 +880,285 @@ public:
 
 #pragma region storage
 private:
-    // 创建链表bucket_node
+    // 创建链表bucket_node，以args原位构造元素，构造失败时回收内存
+    template<class... Args>
     bucket_node*
-    make_node(const value_type& kv) {
-        bucket_node* node = bucket_node_alloc.allocate(1);
-        default_alloc.template construct(std::addressof(node->value), kv);
+    make_node(Args&&... args) {
+        bucket_node* node = create_node(std::forward<Args>(args)...);
         ++this->elements;
         return node;
     }
 
-    // 下一个非空结点，没有就返回nullptr
+    // 同 make_node，但不计入元素个数，可以在多个线程中同时调用
+    template<class... Args>
     bucket_node*
-    next_node(bucket_node* cur) const {
-        if (cur == nullptr) return nullptr;
-        bucket_node* old = cur;
-        cur = cur->next;
-        if (cur == nullptr) {
-            size_t pos = bucket_index(old->value.first);
-            size_t buckets_size = buckets.size();
-            while (!cur && ++pos < buckets_size) cur = buckets[pos];
+    create_node(Args&&... args) {
+        bucket_node* node = bucket_node_alloc.allocate(1);
+        try {
+            default_alloc.template construct(std::addressof(node->value), std::forward<Args>(args)...);
+        }
+        catch (...) {
+            bucket_node_alloc.deallocate(node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    // 将 (cur, index) 移动到下一个结点，cur为nullptr时直接从index的下一个桶开始找
+    // 链尾只需沿着桶数组向后扫描，不需要重新计算哈希；没有下一个结点时变为 (nullptr, 桶的个数)
+    void
+    next_node(bucket_node*& cur, size_t& index) const {
+        if (cur && (cur = cur->next)) return;
+        size_t buckets_size = bucket_end();
+        while (++index < buckets_size) {
+            if ((cur = bucket_at(index))) return;
         }
-        return cur;
+        index = buckets_size;
     }
 
-    // 令 pre->next = next, 当pre为nullptr时，令 buckets[index] = next
+    // 令 pre->next = next, 当pre为nullptr时，令第index个桶的头结点为next
     void
     connect_next(bucket_node* pre, bucket_node* next, size_t index) {
-        (pre ? pre->next : buckets[index]) = next;
+        (pre ? pre->next : bucket_at(index)) = next;
     }
 
-    // 析构并回收buckets里的每个元素
+    // 析构并回收新旧桶数组里的每个元素，正在进行的rehash随之结束
+    // 使用私有结点池时整块归还，元素可以平凡析构时不遍历结点
     void
     destroy_all() {
+        if constexpr (slab_nodes) {
+            for (bucket_container* container : {&old_buckets, &buckets}) {
+                for (auto& ptr : *container) {
+                    if constexpr (!std::is_trivially_destructible_v<value_type>) {
+                        for (bucket_node* node = ptr; node; node = node->next) {
+                            default_alloc.template destroy(std::addressof(node->value));
+                        }
+                    }
+                    ptr = nullptr;
+                }
+            }
+            bucket_node_alloc.release();
+            this->elements = 0;
+            bucket_container().swap(old_buckets);
+            rehash_index = 0;
+            first = buckets.size();
+            return;
+        }
         bucket_node* temp;
-        for (auto& ptr : buckets) {
-            auto bucket = ptr;
-            ptr = nullptr;
-            while (bucket) {
-                temp = bucket->next;
-                destroy_node(bucket);
-                bucket = temp;
+        for (bucket_container* container : {&old_buckets, &buckets}) {
+            for (auto& ptr : *container) {
+                auto bucket = ptr;
+                ptr = nullptr;
+                while (bucket) {
+                    temp = bucket->next;
+                    destroy_node(bucket);
+                    bucket = temp;
+                }
             }
         }
+        bucket_container().swap(old_buckets);
+        rehash_index = 0;
+        first = buckets.size();
     }
 
     // 析构并回收链表的一个节点
     void
     destroy_node(bucket_node*& node) {
-        default_alloc.template destroy(std::addressof(node->value));
-        bucket_node_alloc.deallocate(node, 1);
+        free_node(node);
         node = nullptr;
         --this->elements;
     }
+
+    // 同 destroy_node，但不计入元素个数，可以在多个线程中同时调用
+    void
+    free_node(bucket_node* node) {
+        default_alloc.template destroy(std::addressof(node->value));
+        bucket_node_alloc.deallocate(node, 1);
+    }
+#pragma endregion
+
+
+#pragma region 并行实现
+private:
+    // 每个线程至少处理的元素个数，再少时线程的开销超过收益
+    constexpr static size_t parallel_grain = 1 << 14;
+
+    // 分组中的结点及其哈希值
+    // 并行操作用到的临时数组：分组在多个线程中同时增长，调用线程本身也可能是线程池的工作线程，都不能使用全局的内存池
+    template<class U>
+    using parallel_vector = anya::vector<U, anya::malloc_allocator<U>>;
+
+    struct placed_node {
+        bucket_node* node;
+        size_t       code;
+    };
+
+    // 并行操作都分两步：先由各线程处理输入的一段，把结点按目标桶所在的区段分组到 groups[线程][区段]；
+    // 再由各线程各自独占若干个桶区段，依次取出所有线程在该区段的分组链入。桶区段互不相交，链入时不需要加锁
+    // 每个线程对应多个桶区段，链长不均时也能动态平衡
+    struct parallel_groups {
+        using group_type = parallel_vector<placed_node>;
+
+        size_t bucket_size, sources, parts, chunk;
+        parallel_vector<group_type> groups;
+
+        parallel_groups(size_t bucket_size, size_t sources)
+            : bucket_size(bucket_size), sources(sources),
+              parts(anya::min(bucket_size, sources * 4)),
+              chunk((bucket_size + parts - 1) / parts),
+              groups(sources * parts) {}
+
+        group_type&
+        at(size_t source, size_t part) { return groups[source * parts + part]; }
+
+        void
+        add(size_t source, bucket_node* node, size_t code) {
+            at(source, RehashPolicy::index(code, bucket_size) / chunk).push_back({node, code});
+        }
+    };
+
+    template<bool Unique, class RandomIt>
+    size_type
+    insert_parallel(RandomIt first, RandomIt last, size_t threads, thread_pool& pool) {
+        size_t n = last - first, before = size();
+        // 私有结点池不是线程安全的，只能逐个插入
+        threads = slab_nodes ? 1 : parallel_threads(n, threads == 0 ? pool.size() : threads, parallel_grain);
+        reserve(this->elements + n, threads, pool);
+        if (threads == 1) {
+            for (; first != last; ++first) {
+                if constexpr (Unique) emplace_unique(*first);
+                else emplace_multi(*first);
+            }
+            return size() - before;
+        }
+        finish_rehash();
+
+        // 全局的内存池不是线程安全的，结点的内存由调用线程一次分配好，各线程只在其中构造元素
+        parallel_vector<bucket_node*> nodes(n, nullptr);
+        size_t allocated = 0;
+        try {
+            for (; allocated < n; ++allocated) nodes[allocated] = bucket_node_alloc.allocate(1);
+        }
+        catch (...) {
+            for (size_t i = 0; i < allocated; ++i) bucket_node_alloc.deallocate(nodes[i], 1);
+            throw;
+        }
+
+        // 第一步：各线程在输入的一段上构造元素并按目标桶分组，built[t] 为第t段已经构造好的元素个数
+        parallel_groups state(buckets.size(), threads);
+        size_t slice = (n + threads - 1) / threads;
+        parallel_vector<size_t> built(threads, 0);
+        try {
+            pool.run(threads, [&](size_t t) {
+                for (size_t i = t * slice, end = anya::min(n, i + slice); i < end; ++i) {
+                    bucket_node* node = nodes[i];
+                    default_alloc.template construct(std::addressof(node->value), first[i]);
+                    ++built[t];
+                    size_t code = hash_fcn(node_key(node));
+                    store_hash_code(node, code);
+                    state.add(t, node, code);
+                }
+            });
+        }
+        catch (...) {
+            for (size_t t = 0; t < threads; ++t) {
+                for (size_t i = t * slice, end = i + built[t]; i < end; ++i) {
+                    default_alloc.template destroy(std::addressof(nodes[i]->value));
+                }
+            }
+            for (bucket_node* node : nodes) bucket_node_alloc.deallocate(node, 1);
+            throw;
+        }
+
+        // 第二步：各线程链入自己的桶区段，按输入顺序处理，重复的key保留先出现的；链入的结点在分组中置空
+        // 比较key抛出异常时该区段停止链入，已链入的计入元素个数，没有链入的结点最后由调用线程回收
+        parallel_vector<size_t> inserted(state.parts, 0), lowest(state.parts, buckets.size());
+        auto commit = [&] {
+            for (size_t p = 0; p < state.parts; ++p) {
+                this->elements += inserted[p];
+                this->first = anya::min(this->first, lowest[p]);
+            }
+            for (auto& group : state.groups) {
+                for (auto& [node, code] : group) {
+                    if (node) free_node(node);
+                }
+            }
+        };
+        try {
+            pool.run(state.parts, [&](size_t p) {
+                for (size_t t = 0; t < threads; ++t) {
+                    for (auto& [node, code] : state.at(t, p)) {
+                        size_t pos = RehashPolicy::index(code, state.bucket_size);
+                        bucket_node* exist = find_by_key(node_key(node), code, pos);
+                        if constexpr (Unique) {
+                            if (exist) continue;
+                        }
+                        if (exist) insert_tail(exist, node);
+                        else insert_head(buckets[pos], node), lowest[p] = anya::min(lowest[p], pos);
+                        node = nullptr;
+                        ++inserted[p];
+                    }
+                }
+            });
+        }
+        catch (...) {
+            commit();
+            throw;
+        }
+        commit();
+        return size() - before;
+    }
+
+    template<class Iter>
+    anya::vector<std::pair<Iter, Iter>>
+    split_ranges(size_t parts) const {
+        anya::vector<std::pair<Iter, Iter>> ranges;
+        size_t total = bucket_end();
+        parts = anya::max(anya::min(parts, total), size_t(1));
+        size_t chunk = (total + parts - 1) / parts;
+        Iter from(first_bucket(), first, this);
+        for (size_t start = chunk; from.current; start += chunk) {
+            // 下一段从 start 之后的第一个非空桶开始
+            size_t index = anya::max(start, from.bucket);
+            bucket_node* node = index < total ? bucket_at(index) : nullptr;
+            if (node == nullptr) next_node(node, index);
+            Iter to(node, index, this);
+            if (from != to) ranges.push_back({from, to});
+            from = to;
+        }
+        return ranges;
+    }
+
+    // rebuild 的并行版本，第一步只读取旧桶，出现异常时表保持不变
+    void
+    rebuild(size_t new_bucket_size, size_t threads, thread_pool& pool) {
+        finish_rehash();
+        threads = parallel_threads(this->elements, threads == 0 ? pool.size() : threads, parallel_grain);
+        if (threads == 1) return rebuild(new_bucket_size);
+        [[maybe_unused]] auto timer = counter.time_rehash();
+        counter.rehash();
+        bucket_container temp(new_bucket_size, nullptr);
+        parallel_groups state(new_bucket_size, threads);
+        size_t old_size = buckets.size(), slice = (old_size + threads - 1) / threads;
+        pool.run(threads, [&](size_t t) {
+            for (size_t i = t * slice, end = anya::min(old_size, i + slice); i < end; ++i) {
+                for (bucket_node* ptr = buckets[i]; ptr; ptr = ptr->next) state.add(t, ptr, node_hash_code(ptr));
+            }
+        });
+        parallel_vector<size_t> lowest(state.parts, new_bucket_size);
+        pool.run(state.parts, [&](size_t p) {
+            for (size_t t = 0; t < threads; ++t) {
+                for (auto [node, code] : state.at(t, p)) {
+                    size_t pos = RehashPolicy::index(code, new_bucket_size);
+                    insert_head(temp[pos], node);
+                    lowest[p] = anya::min(lowest[p], pos);
+                }
+            }
+        });
+        buckets.swap(temp);
+        first = new_bucket_size;
+        for (size_t p = 0; p < state.parts; ++p) first = anya::min(first, lowest[p]);
+    }
 #pragma endregion
 
 
@@ -488,58 +1178,226 @@ private:
         return node;
     }
 
-    // 不重复插入
-    std::pair<iterator, bool>
-    insert_unique(const value_type& kv) {
-        const size_t pos = bucket_index(kv.first);
-        for (auto cur = buckets[pos]; cur != nullptr; cur = cur->next) {
-            if (equal_fcn(cur->value.first, kv.first)) {
-                return {iterator(cur, this), false};
+    // 记录结点的哈希值
+    void
+    store_hash_code(bucket_node* node, size_t code) {
+        if constexpr (cache_hash_code) node->hash_code = code;
+    }
+
+    // 插入前的扩容检查：正在迁移时只迁移一部分旧桶，超载时开始渐进式迁移，未开启渐进式rehash时一次性rehash
+    // 删除过之后的第一次插入还会检查欠载，把桶数组缩小
+    void
+    grow() {
+        if (buckets.empty()) return rebuild(RehashPolicy::next_bucket_count(default_size));
+        if (rehashing()) return migrate_buckets(rehash_step);
+        if (is_overload(this->elements, buckets.size()) == false) {
+            if (shrink_pending) shrink();
+            return;
+        }
+        if (rehash_step == 0) return resize(this->elements);
+        counter.rehash();
+        old_buckets.swap(buckets);
+        buckets.resize(RehashPolicy::next_bucket_count(this->elements), nullptr);
+        rehash_index = 0;
+        migrate_buckets(rehash_step);
+    }
+
+    // 从 rehash_index 开始迁移至多count个非空旧桶，最多跳过 10 * count 个空桶，避免单次插入扫描过多空桶
+    // 旧桶全部迁移完后释放旧桶数组，桶下标整体前移
+    void
+    migrate_buckets(size_t count) {
+        [[maybe_unused]] auto timer = counter.time_rehash();
+        size_t old_size = old_buckets.size(), new_size = buckets.size();
+        size_t empty_visits = count * 10;
+        while (count && rehash_index < old_size) {
+            bucket_node* ptr = old_buckets[rehash_index];
+            if (ptr == nullptr) {
+                ++rehash_index;
+                if (--empty_visits == 0) break;
+                continue;
+            }
+            old_buckets[rehash_index] = nullptr;
+            while (ptr) {
+                bucket_node* next = ptr->next;
+                size_t new_index = RehashPolicy::index(node_hash_code(ptr), new_size);
+                insert_head(buckets[new_index], ptr);
+                first = anya::min(first, old_size + new_index);
+                ptr = next;
             }
+            ++rehash_index, --count;
         }
-        // 直接头插法
-        auto head = insert_head(buckets[pos], make_node(kv));
-        return {iterator(head, this), true};
+        update_first();
+        if (rehash_index < old_size) return;
+        bucket_container().swap(old_buckets);
+        rehash_index = 0;
+        first -= old_size;
     }
 
-    // 可重复插入
-    std::pair<iterator, bool>
-    insert_multi(const value_type& kv) {
-        const size_t pos = bucket_index(kv.first);
-        for (auto cur = buckets[pos]; cur; cur = cur->next) {
-            if (equal_fcn(cur->value.first, kv.first)) {
-                // 尾插法接到cur的后面
-                auto tail = insert_tail(cur, make_node(kv));
-                return {iterator(tail, this), true};
+    // 装载因子低于下限时把桶数缩小到装载因子不超过上限的一半：之后要再删掉一半以上的元素才会再缩小，
+    // 插入一倍的元素才会扩容，在阈值附近交替插入删除也不会反复rehash；不会小于默认的桶数
+    void
+    shrink() {
+        shrink_pending = false;
+        size_t bucket_size = buckets.size();
+        if (static_cast<float>(this->elements) >= static_cast<float>(bucket_size) * min_factor) return;
+        size_t target = std::ceil(2 * static_cast<float>(this->elements) / factor);
+        size_t new_bucket_size = RehashPolicy::next_bucket_count(anya::max(target, default_size));
+        if (new_bucket_size < bucket_size && !rehashing()) rebuild(new_bucket_size);
+    }
+
+    // 把所有结点一次性重新分配到 new_bucket_size 个桶中，正在进行的渐进式rehash先完成
+    void
+    rebuild(size_t new_bucket_size) {
+        finish_rehash();
+        [[maybe_unused]] auto timer = counter.time_rehash();
+        counter.rehash();
+        bucket_container temp(new_bucket_size, nullptr);
+        bucket_node* next;
+        first = new_bucket_size;
+        for (bucket_node* ptr : this->buckets) {
+            while (ptr) {
+                size_t new_index = RehashPolicy::index(node_hash_code(ptr), new_bucket_size);
+                next = ptr->next;
+                insert_head(temp[new_index], ptr);
+                first = anya::min(first, new_index);
+                ptr = next;
             }
         }
-        auto head = insert_head(buckets[pos], make_node(kv));
-        return {iterator(head, this), true};
+        buckets.swap(temp);
     }
 
-    // 深拷贝哈希表
+    // 一次性迁移完所有旧桶
+    void
+    finish_rehash() {
+        if (rehashing()) migrate_buckets(old_buckets.size());
+    }
+
+    // 迁移期间哈希值对应的桶下标：所在旧桶还没迁移时位于旧桶，否则位于新桶
+    // 被移动后的表没有桶数组，此时返回0，查找由 find_by_key 直接判定为不存在
+    [[nodiscard]] size_t
+    locate(size_t code) const {
+        if (buckets.empty()) return 0;
+        if (old_buckets.empty()) return RehashPolicy::index(code, buckets.size());
+        size_t old_size = old_buckets.size(), index = RehashPolicy::index(code, old_size);
+        return index >= rehash_index ? index : old_size + RehashPolicy::index(code, buckets.size());
+    }
+
+    // 统一编号下第index个桶
+    bucket_node*&
+    bucket_at(size_t index) {
+        size_t old_size = old_buckets.size();
+        return index < old_size ? old_buckets[index] : buckets[index - old_size];
+    }
+
+    bucket_node*
+    bucket_at(size_t index) const {
+        size_t old_size = old_buckets.size();
+        return index < old_size ? old_buckets[index] : buckets[index - old_size];
+    }
+
+    // 统一编号下桶的个数，也是 end() 的桶下标
+    [[nodiscard]] size_t
+    bucket_end() const noexcept { return old_buckets.size() + buckets.size(); }
+
+    // 不重复插入，由调用者保证表中没有相同的key，code为结点key的哈希值
+    iterator
+    insert_unique_node(bucket_node* node, size_t code) {
+        store_hash_code(node, code);
+        grow();
+        const size_t pos = locate(code);
+        // 直接头插法
+        auto head = insert_head(bucket_at(pos), node);
+        first = anya::min(first, pos);
+        return iterator(head, pos, this);
+    }
+
+    // 可重复插入，相同的key必须相邻，所以接到第一个相同key的后面
+    iterator
+    insert_multi_node(bucket_node* node, size_t code) {
+        store_hash_code(node, code);
+        grow();
+        const size_t pos = locate(code);
+        if (bucket_node* cur = find_by_key(node_key(node), code, pos)) {
+            // 尾插法接到cur的后面
+            auto tail = insert_tail(cur, node);
+            return iterator(tail, pos, this);
+        }
+        auto head = insert_head(bucket_at(pos), node);
+        first = anya::min(first, pos);
+        return iterator(head, pos, this);
+    }
+
+    // 能否不构造结点，直接从 emplace 的参数中取出key
+    // 映射支持 (key, args)、(pair) 和 (piecewise_construct, tuple(key), tuple(args...)) 三种形式，集合支持 (key)
+    template<class... Args>
+    constexpr static bool
+    extractable_key() {
+        if constexpr (!is_map) {
+            if constexpr (sizeof...(Args) != 1) return false;
+            else return std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>, Key>;
+        }
+        else if constexpr (sizeof...(Args) == 1) {
+            using A0 = std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>;
+            if constexpr (requires { typename A0::first_type; })
+                return std::is_same_v<std::remove_cvref_t<typename A0::first_type>, Key>;
+            else return false;
+        }
+        else if constexpr (sizeof...(Args) == 2) {
+            return std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>, Key>;
+        }
+        else if constexpr (sizeof...(Args) == 3) {
+            using A0 = std::remove_cvref_t<std::tuple_element_t<0, std::tuple<Args...>>>;
+            using A1 = std::remove_cvref_t<std::tuple_element_t<1, std::tuple<Args...>>>;
+            if constexpr (!std::is_same_v<A0, std::piecewise_construct_t>) return false;
+            else if constexpr (std::tuple_size_v<A1> != 1) return false;
+            else return std::is_same_v<std::remove_cvref_t<std::tuple_element_t<0, A1>>, Key>;
+        }
+        else return false;
+    }
+
+    template<class A0, class... Rest>
+    static const Key&
+    extract_key(const A0& a0, const Rest&... rest) {
+        if constexpr (!is_map) return a0;
+        else if constexpr (sizeof...(Rest) == 0) return a0.first;
+        else if constexpr (std::is_same_v<A0, std::piecewise_construct_t>)
+            return std::get<0>(std::get<0>(std::forward_as_tuple(rest...)));
+        else return a0;
+    }
+
+    // 深拷贝哈希表，正在进行的rehash也按原样复制
     void
     deep_copy_from(const hashtable& other) {
         clear();
-        size_t bucket_size = other.buckets.size();
-        buckets.resize(bucket_size, nullptr);
+        old_buckets.resize(other.old_buckets.size(), nullptr);
+        buckets.resize(other.buckets.size(), nullptr);
+        size_t bucket_size = other.bucket_end();
         for (size_t i = 0; i < bucket_size; ++i) {
-            if (auto ptr = other.buckets[i]) {
+            if (auto ptr = other.bucket_at(i)) {
                 while (ptr) {
                     bucket_node* temp = make_node(ptr->value);
-                    insert_head(buckets[i], temp);
+                    store_hash_code(temp, other.node_hash_code(ptr));
+                    insert_head(bucket_at(i), temp);
                     ptr = ptr->next;
                 }
             }
         }
+        first = other.first;
+        factor = other.factor, min_factor = other.min_factor, shrink_pending = other.shrink_pending;
+        rehash_index = other.rehash_index, rehash_step = other.rehash_step;
     }
 
-    // 获取第一个非空的bucket
+    // 获取第一个非空的bucket的头结点
     bucket_node*
     first_bucket() const {
-        auto it = buckets.cbegin(), finish = buckets.cend();
-        while (*it == nullptr && it != finish) ++it;
-        return it == finish ? nullptr : *it;
+        return first < bucket_end() ? bucket_at(first) : nullptr;
+    }
+
+    // 删除结点后，第一个非空桶只可能向后移动
+    void
+    update_first() {
+        size_t buckets_size = bucket_end();
+        while (first < buckets_size && bucket_at(first) == nullptr) ++first;
     }
 
     // 判断是否超载, 超载返回true
@@ -548,51 +1406,191 @@ private:
         return static_cast<float>(element_size) > static_cast<float>(bucket_size) * factor;
     }
 
-    // 获取最接近target的primer
+    // 根据哈希函数获取key在bucket中应该位于的下标
+    template<class K>
     [[nodiscard]] size_t
-    next_primer(size_t target) const {
-        auto finish = primers + number_of_primer;
-        auto it = std::lower_bound(primers, finish, target);
-        return it == finish ? *--finish : *it;
+    bucket_index(const K& key) const {
+        return RehashPolicy::index(hash_fcn(key), buckets.size());
     }
 
-    // 根据哈希函数获取key在size个bucket中应该位于的下标
+    [[nodiscard]] static const Key&
+    node_key(const bucket_node* node) noexcept { return KeyPolicy::key(node->value); }
+
+    // 结点的哈希值，有缓存时直接读取
     [[nodiscard]] size_t
-    bucket_index(const Key& key, size_t size) const {
-        return hash_fcn(key) % size;
+    node_hash_code(const bucket_node* node) const {
+        if constexpr (cache_hash_code) return node->hash_code;
+        else return hash_fcn(node_key(node));
     }
 
-    [[nodiscard]] size_t
-    bucket_index(const Key& key) const {
-        return bucket_index(key, buckets.size());
+    // 判断结点的key是否等于key，code为key的哈希值，有缓存时先比较哈希值
+    template<class K>
+    [[nodiscard]] bool
+    node_equals(const bucket_node* node, const K& key, size_t code) const {
+        if constexpr (cache_hash_code) {
+            if (node->hash_code != code) return false;
+        }
+        return equal_fcn(node_key(node), key);
     }
 
-    // 查找第一个k为key的结点
+    // 在第pos个桶中查找第一个k为key的结点，被移动后的表没有桶数组，直接判定为不存在
+    template<class K>
     bucket_node*
-    find_by_key(const Key& key) const {
-        size_t pos = bucket_index(key);
-        bucket_node* current = buckets[pos];
-        while (current && !equal_fcn(current->value.first, key)) current = current->next;
+    find_by_key(const K& key, size_t code, size_t pos) const {
+        if (buckets.empty()) return nullptr;
+        bucket_node* current = bucket_at(pos);
+        size_t probes = 0;
+        while (current && (++probes, !node_equals(current, key, code))) current = current->next;
+        counter.lookup(probes);
         return current;
     }
 
-    // 查找k为key的结点范围
-    std::pair<bucket_node*, bucket_node*>
-    find_range_by_key(const Key& key) const {
-        bucket_node* start = find_by_key(key);
-        bucket_node* finish = start ? start->next : nullptr;
-        while (finish && equal_fcn(finish->value.first, key)) finish = finish->next;
-        return {start, finish};
+    // 查找第一个k为key的结点及其桶下标，找不到时返回 (nullptr, 桶的个数)
+    template<class K>
+    std::pair<bucket_node*, size_t>
+    find_position(const K& key) const {
+        size_t code = hash_fcn(key), pos = locate(code);
+        bucket_node* node = find_by_key(key, code, pos);
+        return {node, node ? pos : bucket_end()};
+    }
+
+    template<class K>
+    size_t
+    count_by_key(const K& key) const {
+        size_t cnt = 0, code = hash_fcn(key);
+        bucket_node* current = find_by_key(key, code, locate(code));
+        while (current && node_equals(current, key, code))
+            current = current->next, ++cnt;
+        return cnt;
+    }
+
+    template<class K>
+    node_type
+    extract_by_key(const K& key) {
+        auto [node, pos] = find_position(key);
+        if (node == nullptr) return node_type();
+        return extract(const_iterator(node, pos, this));
+    }
+
+    template<class K>
+    size_t
+    erase_by_key(const K& key) {
+        if (buckets.empty()) return 0;
+        size_t code = hash_fcn(key), index = locate(code), cnt = 0;
+        bucket_node* current = bucket_at(index);
+        bucket_node* pre = nullptr, *next = nullptr;
+        size_t probes = 0;
+        while (current && (++probes, !node_equals(current, key, code)))
+            pre = current, current = current->next;
+        counter.lookup(probes);
+        // 因为相同的值肯定在同一个哈希桶里，所以这里可以直接返回
+        if (!current) return 0;
+        do {
+            next = current->next, destroy_node(current);
+            current = next, ++cnt;
+        } while (current && node_equals(current, key, code));
+        connect_next(pre, current, index);
+        update_first();
+        shrink_pending = true;
+        return cnt;
+    }
+
+    // 查找k为key的迭代器范围，返回 (结点, 桶下标) 对，范围的结尾可能位于后面的桶里
+    template<class K>
+    std::pair<std::pair<bucket_node*, size_t>, std::pair<bucket_node*, size_t>>
+    equal_range_position(const K& key) const {
+        size_t code = hash_fcn(key), pos = locate(code), index = pos;
+        bucket_node* start = find_by_key(key, code, pos);
+        if (start == nullptr) return {{nullptr, bucket_end()}, {nullptr, bucket_end()}};
+        bucket_node* finish = start->next;
+        while (finish && node_equals(finish, key, code)) finish = finish->next;
+        if (finish == nullptr) next_node(finish, index);
+        return {{start, pos}, {finish, index}};
+    }
+
+    // 批量接口每组处理的key数，足够覆盖内存延迟，又不至于让预取的数据在用到之前被挤出L1
+    constexpr static size_t batch_size = 16;
+
+    constexpr static auto identity_key = [](const auto& key) -> const auto& { return key; };
+    constexpr static auto value_key = [](const auto& value) -> const auto& {
+        if constexpr (is_map) return value.first;
+        else return value;
+    };
+
+    static void
+    prefetch(const void* address) {
+#if defined(__GNUC__)
+        __builtin_prefetch(address);
+#endif
+    }
+
+    // 第index个桶在桶数组中的地址
+    const bucket_node* const*
+    bucket_address(size_t index) const {
+        size_t old_size = old_buckets.size();
+        return index < old_size ? &old_buckets[index] : &buckets[index - old_size];
+    }
+
+    // 从first开始取至多 batch_size 个元素，计算哈希和桶下标并预取桶，返回取出的个数，first移动到下一组的开头
+    template<class ForwardIt, class Proj>
+    size_t
+    prepare_batch(ForwardIt& first, ForwardIt last, ForwardIt* items,
+                  size_t* codes, size_t* positions, Proj proj) const {
+        size_t n = 0;
+        for (; n < batch_size && first != last; ++n, ++first) {
+            items[n] = first;
+            codes[n] = hash_fcn(proj(*first));
+            positions[n] = locate(codes[n]);
+            prefetch(bucket_address(positions[n]));
+        }
+        return n;
+    }
+
+    // 三组轮转的流水线：第g轮预取第g组的桶、第g-1组的链表头结点，并对第g-2组的每个元素调用 func(迭代器, 哈希值, 桶下标)
+    // 每个元素的桶和头结点都提前一整组被预取，func 按输入顺序调用
+    template<class ForwardIt, class Proj, class F>
+    void
+    pipeline_batch(ForwardIt first, ForwardIt last, Proj proj, F&& func) const {
+        size_t codes[3][batch_size], positions[3][batch_size], counts[3]{};
+        ForwardIt items[3][batch_size];
+        for (size_t g = 0; ; ++g) {
+            size_t fetch = g % 3, head = (g + 2) % 3, resolve = (g + 1) % 3;
+            counts[fetch] = prepare_batch(first, last, items[fetch], codes[fetch], positions[fetch], proj);
+            for (size_t i = 0; i < counts[head]; ++i) {
+                if (bucket_node* node = bucket_at(positions[head][i])) prefetch(node);
+            }
+            for (size_t i = 0; i < counts[resolve]; ++i)
+                func(items[resolve][i], codes[resolve][i], positions[resolve][i]);
+            if (counts[fetch] == 0 && counts[head] == 0) break;
+        }
+    }
+
+    // 批量查找，对每个key调用 func(结点, 桶下标)，结点为nullptr表示不存在
+    template<class ForwardIt, class F>
+    void
+    lookup_batch(ForwardIt first, ForwardIt last, F&& func) const {
+        if (buckets.empty()) {
+            for (; first != last; ++first) func(nullptr, bucket_end());
+            return;
+        }
+        pipeline_batch(first, last, identity_key, [this, &func](ForwardIt it, size_t code, size_t pos) {
+            func(find_by_key(*it, code, pos), pos);
+        });
     }
 
     // 查找是否存在这个kv
     bool
     contain_by_key_value(const value_type& kv) const {
-        // DONE: range.first 向后迭代时不能是 ++range.first，否则会错过 range.first != range.second
-        for (auto range = find_range_by_key(kv.first); range.first != range.second; range.first = range.first->next) {
-            if (range.first->value.second == kv.second) return true;
+        const Key& key = KeyPolicy::key(kv);
+        size_t code = hash_fcn(key);
+        bucket_node* current = find_by_key(key, code, locate(code));
+        if constexpr (!is_map) return current != nullptr;
+        else {
+            for (; current && node_equals(current, key, code); current = current->next) {
+                if (current->value.second == kv.second) return true;
+            }
+            return false;
         }
-        return false;
     }
 #pragma endregion
 };
@@ -601,12 +1599,14 @@ private:
 template<
     class Key,
     class T,
-    class Hash      = std::hash<Key>,
+    class Hash      = anya::hash<Key>,
     class KeyEqual  = std::equal_to<Key>,
-    class Allocator = anya::allocator<std::pair<const Key, T>>>
+    class Allocator = anya::allocator<std::pair<const Key, T>>,
+    class RehashPolicy = anya::default_rehash_policy,
+    class KeyPolicy = anya::map_key_policy<Key, T>>
 constexpr void
-swap(anya::hashtable<Key, T, Hash, KeyEqual, Allocator>& lhs,
-     anya::hashtable<Key, T, Hash, KeyEqual, Allocator>& rhs) noexcept {
+swap(anya::hashtable<Key, T, Hash, KeyEqual, Allocator, RehashPolicy, KeyPolicy>& lhs,
+     anya::hashtable<Key, T, Hash, KeyEqual, Allocator, RehashPolicy, KeyPolicy>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
@@ -0,0 +1,229 @@
+//
+// Created by Anya on 2023/8/22.
+//
+
+#ifndef ANYA_STL_PERFECT_HASH_HPP
+#define ANYA_STL_PERFECT_HASH_HPP
+
+#include "functional/hash.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace anya {
+
+// 静态key集合上的最小完美哈希（CHD：hash and displace）
+// 每个key只计算一次64位哈希值 h，第一级用 h 把n个key分到 b 个桶中，
+// 再按桶从大到小为每个桶找一个种子 s，使桶内所有key的 hash_int(h ^ s) 都落到互不相同的空槽位；
+// 只有一个key的桶直接记下空槽位的下标，不再需要第二级混合
+// 槽位数恰好为n，没有空槽位；查找时计算一次哈希、读一个种子、比较一次key
+// 桶数 b 越少种子占的空间越小，但构造时需要尝试更多的种子
+
+#pragma region 编译期哈希
+// 可以在编译期求值的哈希函数，编译期与运行期的结果相同
+template<class Key>
+struct frozen_hash;
+
+template<class Key>
+requires std::is_integral_v<Key> || std::is_enum_v<Key>
+struct frozen_hash<Key> {
+    constexpr uint64_t
+    operator()(Key key) const noexcept {
+        using U = typename std::conditional_t<std::is_enum_v<Key>, std::underlying_type<Key>, std::type_identity<Key>>::type;
+        return hash_int(uint64_t(static_cast<U>(key)));
+    }
+};
+
+template<>
+struct frozen_hash<std::string_view> {
+    using is_transparent = void;
+
+    // 与 hash_bytes 的短串部分相同的读取方式，每16字节一次128位乘法
+    constexpr uint64_t
+    operator()(std::string_view str) const noexcept {
+        size_t len = str.size();
+        uint64_t a, b, seed = hash_secret[0];
+        if (len <= 16) {
+            if (len >= 8) a = read(str, 0, 8), b = read(str, len - 8, 8);
+            else if (len >= 4) a = read(str, 0, 4), b = read(str, len - 4, 4);
+            else if (len > 0) a = (byte(str, 0) << 16) | (byte(str, len >> 1) << 8) | byte(str, len - 1), b = 0;
+            else a = b = 0;
+        }
+        else {
+            size_t i = 0;
+            for (; i + 16 < len; i += 16) seed = hash_mix(read(str, i, 8) ^ hash_secret[1], read(str, i + 8, 8) ^ seed);
+            a = read(str, len - 16, 8), b = read(str, len - 8, 8);
+        }
+        return hash_mix(a ^ hash_secret[1] ^ len, b ^ seed);
+    }
+
+private:
+    static constexpr uint64_t
+    byte(std::string_view str, size_t pos) noexcept { return static_cast<unsigned char>(str[pos]); }
+
+    // 按小端读取n（4或8）个字节，运行期在小端机器上直接读取
+    static constexpr uint64_t
+    read(std::string_view str, size_t pos, size_t n) noexcept {
+        if (!std::is_constant_evaluated() && std::endian::native == std::endian::little) {
+            if (n == 8) return hash_read8(reinterpret_cast<const unsigned char*>(str.data() + pos));
+            return hash_read4(reinterpret_cast<const unsigned char*>(str.data() + pos));
+        }
+        uint64_t word = 0;
+        for (size_t j = 0; j < n; ++j) word |= byte(str, pos + j) << (8 * j);
+        return word;
+    }
+};
+
+template<>
+struct frozen_hash<std::string> : frozen_hash<std::string_view> {};
+#pragma endregion
+
+
+#pragma region 构造
+// 种子的最高位为1时，低位就是桶中唯一key的槽位，所以key的个数不能超过 2^31
+constexpr uint32_t perfect_hash_direct = uint32_t(1) << 31;
+
+// 把64位哈希值均匀地映射到 [0, n)，用乘法代替取模（fastrange），只用到哈希值的高位
+constexpr size_t
+perfect_hash_reduce(uint64_t hash, size_t n) {
+    uint64_t high = n;
+    hash_mum(hash, high);
+    return high;
+}
+
+// 由哈希值、种子得到槽位
+constexpr size_t
+perfect_hash_slot(uint64_t hash, uint32_t seed, size_t n) {
+    return seed & perfect_hash_direct ? seed & ~perfect_hash_direct : perfect_hash_reduce(hash_int(hash ^ seed), n);
+}
+
+// 为 key_at(0) ~ key_at(n - 1) 构造最小完美哈希，分成 bucket_count 个桶
+// seeds 至少有 bucket_count 个元素，slots 至少有n个元素，是输出：slots[槽位] 为key的下标
+// hashes、order 至少有n个元素，bucket_start 至少有 bucket_count + 1 个元素，taken 至少有 (n + 63) / 64 个元素，是临时空间；
+// 各个数组可以是 std::array 也可以是 anya::vector
+// 有相同的key时抛出 std::invalid_argument，在编译期求值时表现为编译错误
+template<class KeyAt, class Hash, class KeyEqual, class Seeds, class Slots, class Hashes, class Scratch, class Starts, class Bitmap>
+constexpr void
+build_perfect_hash(size_t n, size_t bucket_count, KeyAt key_at, const Hash& hash, const KeyEqual& equal,
+                   Seeds& seeds, Slots& slots, Hashes& hashes, Scratch& order, Starts& bucket_start, Bitmap& taken) {
+    if (n >= perfect_hash_direct) throw std::length_error("too many keys for perfect hash");
+    for (size_t i = 0; i < bucket_count; ++i) seeds[i] = 0;
+    for (size_t i = 0; i <= bucket_count; ++i) bucket_start[i] = 0;
+    for (size_t i = 0; i < (n + 63) / 64; ++i) taken[i] = 0;
+
+    // 计数排序，同一个桶的key排在一起，桶 i 占 order[bucket_start[i], bucket_start[i + 1])
+    // hashes 与 order 的顺序相同，试探种子时顺序访问；为此哈希值计算两次，第一次只用来计数
+    for (size_t i = 0; i < n; ++i) ++bucket_start[perfect_hash_reduce(hash(key_at(i)), bucket_count) + 1];
+    size_t max_size = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+        max_size = std::max(max_size, size_t(bucket_start[i + 1]));
+        bucket_start[i + 1] += bucket_start[i];
+    }
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t h = hash(key_at(i));
+        size_t pos = bucket_start[perfect_hash_reduce(h, bucket_count)]++;
+        hashes[pos] = h, order[pos] = i;
+    }
+    for (size_t i = bucket_count; i > 0; --i) bucket_start[i] = bucket_start[i - 1];
+    bucket_start[0] = 0;
+
+    // 大桶先放，这时空槽位多，需要尝试的种子少
+    for (size_t size = max_size; size >= 2; --size) {
+        for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+            size_t begin = bucket_start[bucket], end = bucket_start[bucket + 1];
+            if (end - begin != size) continue;
+            // 哈希值相同的两个key无论种子如何都会冲突
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t j = i + 1; j < end; ++j) {
+                    if (hashes[i] != hashes[j]) continue;
+                    if (equal(key_at(order[i]), key_at(order[j]))) throw std::invalid_argument("duplicate key in perfect hash");
+                    throw std::invalid_argument("hash collision in perfect hash");
+                }
+            }
+            // 依次尝试种子，桶内所有key都落在空槽位时才占用，否则撤销重试
+            // 只在位图上试探，位图比 slots 小得多，大部分访问都能命中缓存
+            for (uint64_t attempt = 1; ; ++attempt) {
+                uint32_t seed = uint32_t(hash_int(attempt)) & ~perfect_hash_direct;
+                size_t placed = begin;
+                while (placed < end) {
+                    size_t slot = perfect_hash_slot(hashes[placed], seed, n);
+                    if (taken[slot / 64] >> (slot % 64) & 1) break;
+                    taken[slot / 64] |= uint64_t(1) << (slot % 64);
+                    ++placed;
+                }
+                if (placed == end) {
+                    seeds[bucket] = seed;
+                    for (size_t i = begin; i < end; ++i) slots[perfect_hash_slot(hashes[i], seed, n)] = order[i];
+                    break;
+                }
+                while (placed-- > begin) {
+                    size_t slot = perfect_hash_slot(hashes[placed], seed, n);
+                    taken[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+                }
+            }
+        }
+    }
+    // 单个key直接放进下一个空槽位
+    size_t free_slot = 0;
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        size_t begin = bucket_start[bucket];
+        if (bucket_start[bucket + 1] - begin != 1) continue;
+        while (taken[free_slot / 64] >> (free_slot % 64) & 1) ++free_slot;
+        taken[free_slot / 64] |= uint64_t(1) << (free_slot % 64);
+        slots[free_slot] = order[begin];
+        seeds[bucket] = perfect_hash_direct | uint32_t(free_slot);
+    }
+}
+
+// 查找哈希值为 hash 的key可能所在的槽位，n不能为0
+template<class Seeds>
+constexpr size_t
+perfect_hash_find(uint64_t hash, const Seeds& seeds, size_t bucket_count, size_t n) {
+    return perfect_hash_slot(hash, seeds[perfect_hash_reduce(hash, bucket_count)], n);
+}
+#pragma endregion
+
+
+#pragma region 编译期完美哈希表
+// 足以表示 [0, n] 的最小无符号整数类型
+template<size_t N>
+using perfect_hash_index = std::conditional_t<N < std::numeric_limits<uint8_t>::max(), uint8_t,
+                           std::conditional_t<N < std::numeric_limits<uint16_t>::max(), uint16_t,
+                           std::conditional_t<N < std::numeric_limits<uint32_t>::max(), uint32_t, uint64_t>>>;
+
+// N个key的完美哈希表，只保存种子和槽位，元素本身按初始化顺序由 frozen_map/frozen_set 保存
+// key很少，每个桶平均一个key，构造时几乎不需要重试
+template<size_t N>
+struct perfect_hash_table {
+    std::array<uint32_t, N>              seeds{};
+    std::array<perfect_hash_index<N>, N> slots{};
+
+    template<class KeyAt, class Hash, class KeyEqual>
+    constexpr
+    perfect_hash_table(KeyAt key_at, const Hash& hash, const KeyEqual& equal) {
+        std::array<uint64_t, N> hashes{};
+        std::array<size_t, N> order{};
+        std::array<size_t, N + 1> bucket_start{};
+        std::array<uint64_t, (N + 63) / 64> taken{};
+        build_perfect_hash(N, N, key_at, hash, equal, seeds, slots, hashes, order, bucket_start, taken);
+    }
+
+    // key可能对应的元素下标，调用者还需要比较一次key
+    template<class K, class Hash>
+    [[nodiscard]] constexpr size_t
+    candidate(const K& key, const Hash& hash) const {
+        return slots[perfect_hash_find(hash(key), seeds, N, N)];
+    }
+};
+#pragma endregion
+
+}
+
+#endif //ANYA_STL_PERFECT_HASH_HPP
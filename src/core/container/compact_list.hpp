@@ -0,0 +1,567 @@
+//
+// Created by Anya on 2023/8/27.
+//
+
+#ifndef ANYA_STL_COMPACT_LIST_HPP
+#define ANYA_STL_COMPACT_LIST_HPP
+
+#include "container/vector.hpp"
+#include "container/built-in/compact_storage.hpp"
+#include "iterator/iterator.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace anya {
+
+// 用32位下标连接的双向链表，适合元素很多、每个元素很小的场景
+// 所有结点放在容器自己的两个数组里：links 保存前后两个32位下标，values 保存元素，下标相同的是同一个结点
+// 每个结点只多8字节链接，而 list 的每个结点要多两个64位指针和一次单独的分配；删除的结点进入空闲链表，供之后插入复用
+// links[0] 是虚拟根结点，它的 next 为头结点、prev 为尾结点，结点i的元素在 values[i - 1]
+// 空闲结点的 prev 为 compact_npos；迭代器保存下标，扩容后仍然有效；但扩容会使指向元素的指针和引用失效。最多容纳 2^32 - 2 个元素
+template<class T>
+class compact_list {
+private:
+    static_assert(std::is_same<typename std::remove_cv<T>::type, T>::value,
+                  "anya::compact_list must have a non-const, non-volatile value_type");
+
+#pragma region 内部辅助类
+private:
+    struct compact_link {
+        compact_index next;
+        compact_index prev;
+    };
+
+    template<class Tp>
+    class compact_list_iterator
+        : public anya::iterator<anya::bidirectional_iterator_tag, Tp> {
+    private:
+        friend class compact_list;
+
+        compact_list* list;
+        compact_index current;
+
+    public:
+        using Self = compact_list_iterator<Tp>;
+
+    public:
+        compact_list_iterator() = default;
+
+        compact_list_iterator(const compact_list* belong, compact_index index) noexcept
+            : list(const_cast<compact_list*>(belong)), current(index) {}
+
+        // iterator 能转化为 const_iterator，但反之不行
+        template<typename U>
+        requires std::same_as<U*, T*>
+        compact_list_iterator(const compact_list_iterator<U>& other) noexcept
+            : list(other.list), current(other.current) {}
+
+    public:
+        Tp&
+        operator*() const noexcept { return list->value(current); }
+
+        Tp*
+        operator->() const noexcept { return std::addressof(list->value(current)); }
+
+        Self&
+        operator++() noexcept {
+            return current = list->links[current].next, *this;
+        }
+
+        Self
+        operator++(int) noexcept {
+            Self tmp = *this;
+            return current = list->links[current].next, tmp;
+        }
+
+        Self&
+        operator--() noexcept {
+            return current = list->links[current].prev, *this;
+        }
+
+        Self
+        operator--(int) noexcept {
+            Self tmp = *this;
+            return current = list->links[current].prev, tmp;
+        }
+
+        friend bool
+        operator==(const Self& lhs, const Self& rhs) {
+            return lhs.current == rhs.current;
+        }
+
+        friend bool
+        operator!=(const Self& lhs, const Self& rhs) {
+            return lhs.current != rhs.current;
+        }
+    };
+#pragma endregion
+
+public:
+    using value_type      = T;
+    using pointer         = T*;
+    using const_pointer   = const T*;
+    using reference       = T&;
+    using const_reference = const T&;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+
+public:
+    using iterator               = compact_list_iterator<value_type>;
+    using const_iterator         = compact_list_iterator<const value_type>;
+    using reverse_iterator       = anya::reverse_iterator<iterator>;
+    using const_reverse_iterator = anya::reverse_iterator<const_iterator>;
+
+private:
+    anya::vector<compact_link> links{{0, 0}};       // 结点的链接，links[0] 为根结点
+    compact_storage<T>         values{};            // 结点的元素，values[i - 1] 属于结点i
+    compact_index              free = compact_npos; // 空闲结点组成的单链表，用 next 连接
+    size_t                     elements{};          // 元素个数
+
+#pragma region 构造 && 析构
+public:
+    compact_list() = default;
+
+    compact_list(size_type count, const T& value) {
+        reserve(count);
+        while (count--) emplace_back(value);
+    }
+
+    explicit compact_list(size_type count) {
+        reserve(count);
+        while (count--) emplace_back();
+    }
+
+    template<class InputIt>
+    requires std::derived_from<typename InputIt::iterator_category, anya::input_iterator_tag>
+    compact_list(InputIt first, InputIt last) {
+        for (; first != last; ++first) emplace_back(*first);
+    }
+
+    compact_list(std::initializer_list<T> init) {
+        reserve(init.size());
+        for (auto& value : init) emplace_back(value);
+    }
+
+    // 元素可以平凡复制时整块复制两个数组，否则按链表顺序逐个复制，得到的结点下标是连续的
+    compact_list(const compact_list& other) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            size_t slots = other.links.size() - 1;
+            values.reserve(slots, 0);
+            if (slots) std::memcpy(static_cast<void*>(values.data()), other.values.data(), slots * sizeof(T));
+            links = other.links, free = other.free, elements = other.elements;
+        }
+        else {
+            reserve(other.size());
+            try {
+                for (auto& value : other) emplace_back(value);
+            }
+            catch (...) {
+                clear();
+                throw;
+            }
+        }
+    }
+
+    compact_list(compact_list&& other) noexcept { swap(other); }
+
+    ~compact_list() { clear(); }
+#pragma endregion
+
+
+#pragma region 赋值
+public:
+    compact_list&
+    operator=(const compact_list& other) {
+        if (this != &other) {
+            compact_list temp(other);
+            swap(temp);
+        }
+        return *this;
+    }
+
+    compact_list&
+    operator=(compact_list&& other) noexcept {
+        if (this != &other) {
+            compact_list temp(std::move(other));
+            swap(temp);
+        }
+        return *this;
+    }
+
+    compact_list&
+    operator=(std::initializer_list<T> ilist) {
+        assign(ilist);
+        return *this;
+    }
+
+    void
+    assign(size_type count, const T& value) {
+        clear();
+        reserve(count);
+        while (count--) emplace_back(value);
+    }
+
+    template<class InputIt>
+    requires std::derived_from<typename InputIt::iterator_category, anya::input_iterator_tag>
+    void
+    assign(InputIt first, InputIt last) {
+        clear();
+        for (; first != last; ++first) emplace_back(*first);
+    }
+
+    void
+    assign(std::initializer_list<T> ilist) {
+        clear();
+        reserve(ilist.size());
+        for (auto& value : ilist) emplace_back(value);
+    }
+#pragma endregion
+
+
+#pragma region 访问
+public:
+    reference
+    front() { return *begin(); }
+
+    const_reference
+    front() const { return *cbegin(); }
+
+    reference
+    back() { return *rbegin(); }
+
+    const_reference
+    back() const { return *crbegin(); }
+#pragma endregion
+
+
+#pragma region 迭代器
+public:
+    iterator
+    begin() noexcept { return iterator(this, links[0].next); }
+
+    const_iterator
+    begin() const noexcept { return const_iterator(this, links[0].next); }
+
+    const_iterator
+    cbegin() const noexcept { return begin(); }
+
+    iterator
+    end() noexcept { return iterator(this, 0); }
+
+    const_iterator
+    end() const noexcept { return const_iterator(this, 0); }
+
+    const_iterator
+    cend() const noexcept { return end(); }
+
+    reverse_iterator
+    rbegin() noexcept { return reverse_iterator(end()); }
+
+    const_reverse_iterator
+    rbegin() const noexcept { return const_reverse_iterator(cend()); }
+
+    const_reverse_iterator
+    crbegin() const noexcept { return const_reverse_iterator(cend()); }
+
+    reverse_iterator
+    rend() noexcept { return reverse_iterator(begin()); }
+
+    const_reverse_iterator
+    rend() const noexcept { return const_reverse_iterator(cbegin()); }
+
+    const_reverse_iterator
+    crend() const noexcept { return const_reverse_iterator(cbegin()); }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] bool
+    empty() const noexcept { return elements == 0; }
+
+    [[nodiscard]] size_type
+    size() const noexcept { return elements; }
+
+    [[nodiscard]] constexpr size_type
+    max_size() const noexcept { return compact_max_size - 1; }
+
+    // 不需要扩容就能容纳的元素个数，包括空闲结点
+    [[nodiscard]] size_type
+    capacity() const noexcept { return values.capacity(); }
+
+    void
+    reserve(size_type n) {
+        if (n <= values.capacity()) return;
+        values.reserve(n, live_slots(), [this](size_t i) { return links[i + 1].prev != compact_npos; });
+        links.reserve(n + 1);
+    }
+
+    // 按链表顺序重新排列结点，回收空闲结点和多余的容量，之后顺序遍历就是顺序访问内存；所有迭代器失效
+    void
+    shrink_to_fit() {
+        compact_list temp;
+        temp.values.reserve(elements, 0);
+        temp.links.reserve(elements + 1);
+        for (auto& value : *this) temp.emplace_back(std::move_if_noexcept(value));
+        swap(temp);
+    }
+
+    // 链接与元素数组占用的内存
+    [[nodiscard]] size_t
+    memory_usage() const noexcept {
+        return links.capacity() * sizeof(compact_link) + values.capacity() * sizeof(T);
+    }
+#pragma endregion
+
+
+#pragma region 修改器
+public:
+    void
+    clear() noexcept {
+        for (compact_index i = links[0].next; i != 0; i = links[i].next) anya::destroy_at(std::addressof(value(i)));
+        links.resize(1);
+        links[0] = {0, 0};
+        free = compact_npos, elements = 0;
+    }
+
+    iterator
+    insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+
+    iterator
+    insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+
+    iterator
+    insert(const_iterator pos, size_type count, const T& value) {
+        iterator result(this, pos.current);
+        for (bool first = true; count--; first = false) {
+            iterator it = emplace(pos, value);
+            if (first) result = it;
+        }
+        return result;
+    }
+
+    template<class InputIt>
+    requires std::derived_from<typename InputIt::iterator_category, anya::input_iterator_tag>
+    iterator
+    insert(const_iterator pos, InputIt first, InputIt last) {
+        iterator result(this, pos.current);
+        for (bool head = true; first != last; ++first, head = false) {
+            iterator it = emplace(pos, *first);
+            if (head) result = it;
+        }
+        return result;
+    }
+
+    iterator
+    insert(const_iterator pos, std::initializer_list<T> ilist) { return insert(pos, ilist.begin(), ilist.end()); }
+
+    template<class... Args>
+    iterator
+    emplace(const_iterator pos, Args&&... args) {
+        compact_index node = make_node(std::forward<Args>(args)...);
+        compact_index prev = links[pos.current].prev;
+        connect(prev, node), connect(node, pos.current);
+        return iterator(this, node);
+    }
+
+    iterator
+    erase(const_iterator pos) {
+        compact_index node = pos.current, next = links[node].next;
+        connect(links[node].prev, next);
+        destroy_node(node);
+        return iterator(this, next);
+    }
+
+    iterator
+    erase(const_iterator first, const_iterator last) {
+        while (first != last) first = erase(first);
+        return iterator(this, last.current);
+    }
+
+    template<class... Args>
+    reference
+    emplace_back(Args&&... args) { return *emplace(cend(), std::forward<Args>(args)...); }
+
+    template<class... Args>
+    reference
+    emplace_front(Args&&... args) { return *emplace(cbegin(), std::forward<Args>(args)...); }
+
+    void
+    push_back(const T& value) { emplace_back(value); }
+
+    void
+    push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void
+    push_front(const T& value) { emplace_front(value); }
+
+    void
+    push_front(T&& value) { emplace_front(std::move(value)); }
+
+    void
+    pop_back() { erase(--cend()); }
+
+    void
+    pop_front() { erase(cbegin()); }
+
+    void
+    resize(size_type count) {
+        while (size() > count) pop_back();
+        while (size() < count) emplace_back();
+    }
+
+    void
+    resize(size_type count, const value_type& value) {
+        while (size() > count) pop_back();
+        while (size() < count) emplace_back(value);
+    }
+
+    void
+    swap(compact_list& other) noexcept {
+        links.swap(other.links);
+        values.swap(other.values);
+        std::swap(free, other.free);
+        std::swap(elements, other.elements);
+    }
+#pragma endregion
+
+
+#pragma region 操作
+public:
+    size_type
+    remove(const T& value) {
+        return remove_if([&](const T& elem) { return elem == value; });
+    }
+
+    template<class UnaryPredicate>
+    size_type
+    remove_if(UnaryPredicate p) {
+        size_type removed = 0;
+        for (auto it = cbegin(); it != cend();) {
+            if (p(*it)) it = erase(it), ++removed;
+            else ++it;
+        }
+        return removed;
+    }
+
+    // 只交换每个结点的前后链接，元素不移动
+    void
+    reverse() noexcept {
+        compact_index i = 0;
+        do {
+            std::swap(links[i].next, links[i].prev);
+            i = links[i].prev;
+        } while (i != 0);
+    }
+
+    size_type
+    unique() { return unique(std::equal_to<>()); }
+
+    template<class BinaryPredicate>
+    size_type
+    unique(BinaryPredicate p) {
+        size_type removed = 0;
+        if (empty()) return removed;
+        for (auto prev = cbegin(), it = anya::next(prev); it != cend();) {
+            if (p(*prev, *it)) it = erase(it), ++removed;
+            else prev = it++;
+        }
+        return removed;
+    }
+
+    void
+    sort() { sort(std::less<>()); }
+
+    // 稳定排序，只重新连接结点，元素不移动
+    template<class Compare>
+    void
+    sort(Compare comp) {
+        anya::vector<compact_index> order;
+        order.reserve(elements);
+        for (compact_index i = links[0].next; i != 0; i = links[i].next) order.push_back(i);
+        std::stable_sort(order.data(), order.data() + order.size(),
+                         [&](compact_index a, compact_index b) { return comp(value(a), value(b)); });
+        compact_index prev = 0;
+        for (compact_index node : order) connect(prev, node), prev = node;
+        connect(prev, 0);
+    }
+#pragma endregion
+
+
+#pragma region 友元比较函数
+public:
+    friend bool
+    operator==(const compact_list& lhs, const compact_list& rhs) {
+        return lhs.size() == rhs.size() && anya::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    friend bool
+    operator!=(const compact_list& lhs, const compact_list& rhs) { return !(lhs == rhs); }
+#pragma endregion
+
+
+#pragma region storage
+private:
+    T&
+    value(compact_index node) noexcept { return values[node - 1]; }
+
+    // 已经分配过的结点个数，空闲链表为空时它们都存放着元素
+    size_t
+    live_slots() const noexcept { return links.size() - 1; }
+
+    // 优先复用空闲结点，元素构造成功后才修改链表
+    template<class... Args>
+    compact_index
+    make_node(Args&&... args) {
+        if (free != compact_npos) {
+            compact_index node = free;
+            values.construct(std::addressof(value(node)), std::forward<Args>(args)...);
+            free = links[node].next;
+            ++elements;
+            return node;
+        }
+        size_t node = links.size();
+        if (node >= compact_max_size) throw std::length_error("compact_list exceeds 2^32 - 2 elements");
+        if (live_slots() == values.capacity()) {
+            // args 可能引用链表中的元素，扩容会把它们移走，所以先构造到临时对象中
+            T temp(std::forward<Args>(args)...);
+            values.grow(live_slots());
+            values.construct(std::addressof(value(node)), std::move(temp));
+        }
+        else {
+            values.construct(std::addressof(value(node)), std::forward<Args>(args)...);
+        }
+        try {
+            links.push_back({0, 0});
+        }
+        catch (...) {
+            anya::destroy_at(std::addressof(value(node)));
+            throw;
+        }
+        ++elements;
+        return static_cast<compact_index>(node);
+    }
+
+    void
+    destroy_node(compact_index node) noexcept {
+        anya::destroy_at(std::addressof(value(node)));
+        links[node] = {free, compact_npos}, free = node;
+        --elements;
+    }
+
+    void
+    connect(compact_index prev, compact_index next) noexcept {
+        links[prev].next = next, links[next].prev = prev;
+    }
+#pragma endregion
+};
+
+template<class T>
+constexpr void
+swap(anya::compact_list<T>& lhs, anya::compact_list<T>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif //ANYA_STL_COMPACT_LIST_HPP
@@ -0,0 +1,23 @@
+//
+// Created by Anya on 2023/8/27.
+//
+
+#ifndef ANYA_STL_COMPACT_UNORDERED_MAP_HPP
+#define ANYA_STL_COMPACT_UNORDERED_MAP_HPP
+
+#include "container/built-in/compact_hashtable.hpp"
+
+namespace anya {
+
+// 元素紧密存放、用32位下标连接的无序映射，见 compact_hashtable
+template<
+    class Key,
+    class T,
+    class Hash         = anya::hash<Key>,
+    class KeyEqual     = std::equal_to<Key>,
+    class RehashPolicy = anya::default_rehash_policy>
+using compact_unordered_map = compact_hashtable<Key, T, Hash, KeyEqual, RehashPolicy, anya::map_key_policy<Key, T>>;
+
+}
+
+#endif //ANYA_STL_COMPACT_UNORDERED_MAP_HPP
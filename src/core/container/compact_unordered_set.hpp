@@ -0,0 +1,22 @@
+//
+// Created by Anya on 2023/8/27.
+//
+
+#ifndef ANYA_STL_COMPACT_UNORDERED_SET_HPP
+#define ANYA_STL_COMPACT_UNORDERED_SET_HPP
+
+#include "container/built-in/compact_hashtable.hpp"
+
+namespace anya {
+
+// 元素紧密存放、用32位下标连接的无序集合，见 compact_hashtable
+template<
+    class Key,
+    class Hash         = anya::hash<Key>,
+    class KeyEqual     = std::equal_to<Key>,
+    class RehashPolicy = anya::default_rehash_policy>
+using compact_unordered_set = compact_hashtable<Key, Key, Hash, KeyEqual, RehashPolicy, anya::set_key_policy<Key>>;
+
+}
+
+#endif //ANYA_STL_COMPACT_UNORDERED_SET_HPP
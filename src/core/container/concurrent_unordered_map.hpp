@@ -0,0 +1,247 @@
+//
+// Created by Anya on 2023/8/9.
+//
+
+#ifndef ANYA_STL_CONCURRENT_UNORDERED_MAP_HPP
+#define ANYA_STL_CONCURRENT_UNORDERED_MAP_HPP
+
+#include "container/built-in/hashtable.hpp"
+#include "mutex/spin_lock.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+
+namespace anya {
+
+// 分段加锁的并发哈希表
+// 按哈希值把元素分到若干个分段中，每个分段是一张独立的 hashtable 并由自己的锁保护，
+// 不同分段上的操作互不阻塞，扩容也只锁住触发扩容的那个分段
+// Lock 默认为 anya::spin_lock；若提供 lock_shared/unlock_shared（例如 std::shared_mutex），查找时只加读锁
+// 元素的引用和迭代器无法在锁外安全使用，所以查找返回值的拷贝，原位修改通过 visit 在锁内完成
+template<
+    class Key,
+    class T,
+    class Hash     = anya::hash<Key>,
+    class KeyEqual = std::equal_to<Key>,
+    class Lock     = anya::spin_lock>
+class concurrent_unordered_map {
+public:
+    using key_type    = Key;
+    using mapped_type = T;
+    using value_type  = std::pair<const Key, T>;
+    using size_type   = size_t;
+    using hasher      = Hash;
+    using key_equal   = KeyEqual;
+    using lock_type   = Lock;
+
+private:
+    // 各分段在不同的线程上同时分配结点和桶数组，不能使用全局的内存池，直接向 malloc 申请
+    using table_type = anya::hashtable<Key, T, Hash, KeyEqual, anya::malloc_allocator<std::pair<const Key, T>>>;
+
+    constexpr static bool shared_lockable = requires(Lock& lock) {
+        lock.lock_shared();
+        lock.unlock_shared();
+    };
+
+    using read_guard  = std::conditional_t<shared_lockable, std::shared_lock<Lock>, std::unique_lock<Lock>>;
+    using write_guard = std::unique_lock<Lock>;
+
+    // 每个分段独占缓存行，避免相邻分段的锁互相伪共享
+    struct alignas(64) shard {
+        mutable Lock        lock;
+        table_type          table;
+        std::atomic<size_t> count{};  // 元素数量，供 size() 在不加锁的情况下读取
+    };
+
+    std::unique_ptr<shard[]> shards;
+    size_t                   shard_mask;
+    hasher                   hash_fcn;
+
+#pragma region 构造 && 析构
+public:
+    concurrent_unordered_map() : concurrent_unordered_map(default_shard_count()) {}
+
+    // 分段数取不小于shard_count的2的幂
+    explicit concurrent_unordered_map(size_t shard_count, const hasher& hash = hasher())
+        : shards(new shard[std::bit_ceil(anya::max(shard_count, size_t(1)))]),
+          shard_mask(std::bit_ceil(anya::max(shard_count, size_t(1))) - 1),
+          hash_fcn(hash)
+    {}
+
+    concurrent_unordered_map(const concurrent_unordered_map&) = delete;
+
+    concurrent_unordered_map&
+    operator=(const concurrent_unordered_map&) = delete;
+
+    ~concurrent_unordered_map() = default;
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    // 各分段计数之和，并发修改时只是一个近似值，没有并发修改时是精确值
+    [[nodiscard]] size_type
+    size() const noexcept {
+        size_t total = 0;
+        for (size_t i = 0; i <= shard_mask; ++i) total += shards[i].count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    [[nodiscard]] bool
+    empty() const noexcept { return size() == 0; }
+
+    [[nodiscard]] size_type
+    shard_count() const noexcept { return shard_mask + 1; }
+#pragma endregion
+
+
+#pragma region 修改器
+public:
+    // key不存在时以 (key, args...) 构造元素，返回是否插入
+    template<class... Args>
+    bool
+    emplace(const Key& key, Args&&... args) {
+        shard& s = shard_of(key);
+        write_guard guard(s.lock);
+        bool inserted = s.table.try_emplace(key, std::forward<Args>(args)...).second;
+        if (inserted) s.count.fetch_add(1, std::memory_order_relaxed);
+        return inserted;
+    }
+
+    bool
+    insert(const value_type& value) { return emplace(value.first, value.second); }
+
+    // key存在时赋值，不存在时插入，返回是否插入
+    template<class M>
+    bool
+    insert_or_assign(const Key& key, M&& obj) {
+        shard& s = shard_of(key);
+        write_guard guard(s.lock);
+        bool inserted = s.table.insert_or_assign(key, std::forward<M>(obj)).second;
+        if (inserted) s.count.fetch_add(1, std::memory_order_relaxed);
+        return inserted;
+    }
+
+    // key不存在时才调用 func() 构造值，整个过程持有分段锁，func 只会被调用一次；返回最终的值
+    template<class F>
+    T
+    compute_if_absent(const Key& key, F&& func) {
+        shard& s = shard_of(key);
+        write_guard guard(s.lock);
+        auto it = s.table.find(key);
+        if (it != s.table.end()) return it->second;
+        it = s.table.try_emplace(key, std::forward<F>(func)()).first;
+        s.count.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+
+    // 在锁内对key对应的值调用 func(T&)，返回key是否存在
+    template<class F>
+    bool
+    visit(const Key& key, F&& func) {
+        shard& s = shard_of(key);
+        write_guard guard(s.lock);
+        auto it = s.table.find(key);
+        if (it == s.table.end()) return false;
+        std::forward<F>(func)(it->second);
+        return true;
+    }
+
+    size_type
+    erase(const Key& key) {
+        shard& s = shard_of(key);
+        write_guard guard(s.lock);
+        size_t cnt = s.table.erase(key);
+        s.count.fetch_sub(cnt, std::memory_order_relaxed);
+        return cnt;
+    }
+
+    // 逐个分段清空，不是原子的：清空过程中其他线程插入到已清空分段的元素会被保留
+    void
+    clear() {
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            write_guard guard(shards[i].lock);
+            shards[i].table.clear();
+            shards[i].count.store(0, std::memory_order_relaxed);
+        }
+    }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    [[nodiscard]] std::optional<T>
+    find(const Key& key) const {
+        const shard& s = shard_of(key);
+        read_guard guard(s.lock);
+        auto it = s.table.find(key);
+        if (it == s.table.end()) return std::nullopt;
+        return it->second;
+    }
+
+    [[nodiscard]] bool
+    contains(const Key& key) const {
+        const shard& s = shard_of(key);
+        read_guard guard(s.lock);
+        return s.table.count(key) != 0;
+    }
+
+    // 逐个分段加锁遍历，对每个元素调用 func(const value_type&)
+    template<class F>
+    void
+    for_each(F&& func) const {
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            read_guard guard(shards[i].lock);
+            for (const auto& kv : shards[i].table) func(kv);
+        }
+    }
+#pragma endregion
+
+
+#pragma region 哈希策略
+public:
+    // 每个分段预留 count / 分段数 个元素的空间
+    void
+    reserve(size_type count) {
+        size_t per_shard = count / shard_count() + 1;
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            write_guard guard(shards[i].lock);
+            shards[i].table.reserve(per_shard);
+        }
+    }
+
+    // 为每个分段开启渐进式rehash，单次写操作持锁的最长时间不再随分段大小增长
+    void
+    incremental_rehash(size_t step) {
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            write_guard guard(shards[i].lock);
+            shards[i].table.incremental_rehash(step);
+        }
+    }
+#pragma endregion
+
+
+#pragma region 工具函数
+private:
+    // 默认分段数为硬件线程数的4倍，至少16个
+    static size_t
+    default_shard_count() {
+        return anya::max(size_t(16), size_t(std::thread::hardware_concurrency()) * 4);
+    }
+
+    // 分段下标取 hash * 2^64/φ 的中间位，分段内的 hashtable 使用乘积的高位定位桶，两者互不相关
+    shard&
+    shard_of(const Key& key) const {
+        constexpr size_t digits = std::numeric_limits<size_t>::digits;
+        size_t code = hash_fcn(key) * anya::power2_rehash_policy::golden;
+        return shards[(code >> (digits / 2)) & shard_mask];
+    }
+#pragma endregion
+};
+
+}
+
+#endif //ANYA_STL_CONCURRENT_UNORDERED_MAP_HPP
@@ -511,7 +511,7 @@ public:
             return clear(), finish;
         }
         difference_type n = last - first;
-        difference_type front_elem = first - last;
+        difference_type front_elem = first - start;
         if (front_elem < (size() - n) / 2) {
             anya::move_backward(start, cast_to_iterator(first), cast_to_iterator(last));
             iterator new_start = start + n;
@@ -783,7 +783,7 @@ private:
         size_t node_leave = start.current - start.first;
         if (node_leave < count) {
             // 当前 node 剩余的 slot 不够装，申请分配新的 node 指向的内存
-            size_t nodes = (count - node_leave) / buffer_size + 1;
+            size_t nodes = (count - node_leave - 1) / buffer_size + 1;
             map_pointer cur = start.node - 1;
             while (nodes--) *cur-- = alloc_node();
         }
@@ -800,7 +800,8 @@ private:
             update_map_node((count - leave) / buffer_size + 1, false);
         }
         size_t node_leave = finish.last - finish.current;
-        if (node_leave < count) {
+        // finish 正好落在下一个 node 的开头时，它指向的 node 也必须已经分配
+        if (node_leave <= count) {
             // 当前 node 剩余的 slot 不够装，申请分配新的 node 指向的内存
             size_t nodes = (count - node_leave) / buffer_size + 1;
             map_pointer cur = finish.node + 1;
@@ -814,7 +815,7 @@ private:
     cast_to_iterator(const_iterator other) {
         iterator ret;
         ret.current = const_cast<T*>(other.current);
-        ret.first   = const_cast<T*>(other.current);
+        ret.first   = const_cast<T*>(other.first);
         ret.last    = const_cast<T*>(other.last);
         ret.node    = const_cast<T**>(other.node);
         return ret;
@@ -830,6 +831,16 @@ swap(anya::deque<T, Alloc>& lhs, anya::deque<T, Alloc>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
+// 删除所有满足 pred 的元素，其余元素保持原来的顺序，返回删除的个数
+template<class T, class Alloc, class UnaryPredicate>
+typename anya::deque<T, Alloc>::size_type
+erase_if(anya::deque<T, Alloc>& c, UnaryPredicate pred) {
+    auto it = anya::remove_if(c.begin(), c.end(), pred);
+    auto removed = c.end() - it;
+    c.erase(it, c.end());
+    return removed;
+}
+
 }
 
 #endif //ANYA_STL_DEQUE_HPP
@@ -0,0 +1,140 @@
+//
+// Created by Anya on 2023/8/22.
+//
+
+#ifndef ANYA_STL_FROZEN_MAP_HPP
+#define ANYA_STL_FROZEN_MAP_HPP
+
+#include "container/built-in/perfect_hash.hpp"
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace anya {
+
+// 编译期构造的只读映射
+// 在编译期为给定的key集合计算完美哈希，结果整个放在只读数据段里：启动时不需要构造，不分配内存，查找只比较一次key
+// key可以是整数、枚举或 std::string_view（字符串字面量），其他类型需要提供可以在编译期求值、返回64位哈希值的 Hash
+//
+//   constexpr auto opcodes = anya::make_frozen_map<std::string_view, int>({{"add", 1}, {"sub", 2}});
+//   static_assert(opcodes.at("sub") == 2);
+template<
+    class Key,
+    class T,
+    size_t N,
+    class Hash     = anya::frozen_hash<Key>,
+    class KeyEqual = std::equal_to<Key>>
+class frozen_map {
+public:
+    using key_type        = Key;
+    using mapped_type     = T;
+    using value_type      = std::pair<Key, T>;
+    using size_type       = size_t;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using const_reference = const value_type&;
+    using const_iterator  = const value_type*;
+    using iterator        = const_iterator;
+
+private:
+    std::array<value_type, N> items;    // 按初始化时的顺序保存元素，也是遍历的顺序
+    perfect_hash_table<N>     table;
+    [[no_unique_address]] hasher    hash_fcn;
+    [[no_unique_address]] key_equal equal_fcn;
+
+#pragma region 构造
+public:
+    constexpr explicit
+    frozen_map(const value_type (&init)[N], const hasher& hash = hasher(), const key_equal& equal = key_equal())
+        : frozen_map(init, hash, equal, std::make_index_sequence<N>()) {}
+
+private:
+    template<size_t... I>
+    constexpr
+    frozen_map(const value_type (&init)[N], const hasher& hash, const key_equal& equal, std::index_sequence<I...>)
+        : items{init[I]...},
+          table([&init](size_t i) -> const Key& { return init[i].first; }, hash, equal),
+          hash_fcn(hash), equal_fcn(equal)
+    {}
+#pragma endregion
+
+
+#pragma region 迭代器
+public:
+    constexpr const_iterator
+    begin() const noexcept { return items.data(); }
+
+    constexpr const_iterator
+    cbegin() const noexcept { return begin(); }
+
+    constexpr const_iterator
+    end() const noexcept { return items.data() + N; }
+
+    constexpr const_iterator
+    cend() const noexcept { return end(); }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] constexpr bool
+    empty() const noexcept { return N == 0; }
+
+    [[nodiscard]] constexpr size_type
+    size() const noexcept { return N; }
+
+    [[nodiscard]] constexpr size_type
+    max_size() const noexcept { return N; }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    [[nodiscard]] constexpr const_iterator
+    find(const Key& key) const {
+        size_t index = table.candidate(key, hash_fcn);
+        return index < N && equal_fcn(items[index].first, key) ? items.data() + index : end();
+    }
+
+    [[nodiscard]] constexpr bool
+    contains(const Key& key) const { return find(key) != end(); }
+
+    [[nodiscard]] constexpr size_type
+    count(const Key& key) const { return contains(key); }
+
+    [[nodiscard]] constexpr const T&
+    at(const Key& key) const {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("frozen_map has not this key");
+        return it->second;
+    }
+
+    [[nodiscard]] constexpr std::pair<const_iterator, const_iterator>
+    equal_range(const Key& key) const {
+        auto it = find(key);
+        return {it, it == end() ? it : it + 1};
+    }
+#pragma endregion
+
+
+#pragma region 观察器
+public:
+    constexpr hasher
+    hash_function() const { return hash_fcn; }
+
+    constexpr key_equal
+    key_eq() const { return equal_fcn; }
+#pragma endregion
+};
+
+// 由花括号列表推导元素个数
+template<class Key, class T, class Hash = anya::frozen_hash<Key>, class KeyEqual = std::equal_to<Key>, size_t N>
+constexpr frozen_map<Key, T, N, Hash, KeyEqual>
+make_frozen_map(const std::pair<Key, T> (&init)[N], const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()) {
+    return frozen_map<Key, T, N, Hash, KeyEqual>(init, hash, equal);
+}
+
+}
+
+#endif //ANYA_STL_FROZEN_MAP_HPP
@@ -0,0 +1,121 @@
+//
+// Created by Anya on 2023/8/22.
+//
+
+#ifndef ANYA_STL_FROZEN_SET_HPP
+#define ANYA_STL_FROZEN_SET_HPP
+
+#include "container/built-in/perfect_hash.hpp"
+#include <array>
+#include <functional>
+#include <utility>
+
+namespace anya {
+
+// 编译期构造的只读集合，与 frozen_map 相同，只是不保存值
+//
+//   constexpr auto keywords = anya::make_frozen_set<std::string_view>({"if", "else", "while"});
+//   static_assert(keywords.contains("while"));
+template<
+    class Key,
+    size_t N,
+    class Hash     = anya::frozen_hash<Key>,
+    class KeyEqual = std::equal_to<Key>>
+class frozen_set {
+public:
+    using key_type        = Key;
+    using value_type      = Key;
+    using size_type       = size_t;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using const_reference = const value_type&;
+    using const_iterator  = const value_type*;
+    using iterator        = const_iterator;
+
+private:
+    std::array<value_type, N> items;
+    perfect_hash_table<N>     table;
+    [[no_unique_address]] hasher    hash_fcn;
+    [[no_unique_address]] key_equal equal_fcn;
+
+#pragma region 构造
+public:
+    constexpr explicit
+    frozen_set(const value_type (&init)[N], const hasher& hash = hasher(), const key_equal& equal = key_equal())
+        : frozen_set(init, hash, equal, std::make_index_sequence<N>()) {}
+
+private:
+    template<size_t... I>
+    constexpr
+    frozen_set(const value_type (&init)[N], const hasher& hash, const key_equal& equal, std::index_sequence<I...>)
+        : items{init[I]...},
+          table([&init](size_t i) -> const Key& { return init[i]; }, hash, equal),
+          hash_fcn(hash), equal_fcn(equal)
+    {}
+#pragma endregion
+
+
+#pragma region 迭代器
+public:
+    constexpr const_iterator
+    begin() const noexcept { return items.data(); }
+
+    constexpr const_iterator
+    cbegin() const noexcept { return begin(); }
+
+    constexpr const_iterator
+    end() const noexcept { return items.data() + N; }
+
+    constexpr const_iterator
+    cend() const noexcept { return end(); }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] constexpr bool
+    empty() const noexcept { return N == 0; }
+
+    [[nodiscard]] constexpr size_type
+    size() const noexcept { return N; }
+
+    [[nodiscard]] constexpr size_type
+    max_size() const noexcept { return N; }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    [[nodiscard]] constexpr const_iterator
+    find(const Key& key) const {
+        size_t index = table.candidate(key, hash_fcn);
+        return index < N && equal_fcn(items[index], key) ? items.data() + index : end();
+    }
+
+    [[nodiscard]] constexpr bool
+    contains(const Key& key) const { return find(key) != end(); }
+
+    [[nodiscard]] constexpr size_type
+    count(const Key& key) const { return contains(key); }
+#pragma endregion
+
+
+#pragma region 观察器
+public:
+    constexpr hasher
+    hash_function() const { return hash_fcn; }
+
+    constexpr key_equal
+    key_eq() const { return equal_fcn; }
+#pragma endregion
+};
+
+template<class Key, class Hash = anya::frozen_hash<Key>, class KeyEqual = std::equal_to<Key>, size_t N>
+constexpr frozen_set<Key, N, Hash, KeyEqual>
+make_frozen_set(const Key (&init)[N], const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()) {
+    return frozen_set<Key, N, Hash, KeyEqual>(init, hash, equal);
+}
+
+}
+
+#endif //ANYA_STL_FROZEN_SET_HPP
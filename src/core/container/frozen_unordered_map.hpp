@@ -0,0 +1,288 @@
+//
+// Created by Anya on 2023/8/23.
+//
+
+#ifndef ANYA_STL_FROZEN_UNORDERED_MAP_HPP
+#define ANYA_STL_FROZEN_UNORDERED_MAP_HPP
+
+#include "container/built-in/perfect_hash.hpp"
+#include "container/vector.hpp"
+#include "functional/hash.hpp"
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace anya {
+
+// 运行期构造的只读映射，适合装载一次之后只做查找的表
+// 构造时为所有key计算最小完美哈希，元素按槽位顺序紧密地放在一个数组里，另有每2个key一个32位种子：
+// 没有节点指针和桶数组，每个元素只多占2字节；查找只计算一次哈希，读一个种子，访问一次元素数组
+// 可以从任意范围构造，也可以由 unordered_map::freeze() 得到；有重复的key，或者两个key的哈希值完全相同时抛出 std::invalid_argument
+template<
+    class Key,
+    class T,
+    class Hash      = anya::hash<Key>,
+    class KeyEqual  = std::equal_to<Key>,
+    class Allocator = anya::allocator<std::pair<const Key, T>>>
+class frozen_unordered_map {
+public:
+    using key_type        = Key;
+    using mapped_type     = T;
+    using value_type      = std::pair<const Key, T>;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using allocator_type  = Allocator;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using pointer         = value_type*;
+    using const_pointer   = const value_type*;
+    using const_iterator  = const value_type*;
+    using iterator        = const_iterator;
+
+    // 哈希函数与比较函数是否都是透明的
+    constexpr static bool is_transparent = requires {
+        typename Hash::is_transparent;
+        typename KeyEqual::is_transparent;
+    };
+
+private:
+    value_type*            items{};   // 按槽位顺序排列；key是const的，不能放进需要赋值的 anya::vector
+    size_type              count_{};
+    anya::vector<uint32_t> seeds;
+    [[no_unique_address]] allocator_type alloc;
+    [[no_unique_address]] hasher    hash_fcn;
+    [[no_unique_address]] key_equal equal_fcn;
+
+    // 每个桶平均的key个数，越大种子越少，构造越慢
+    constexpr static size_t bucket_load = 2;
+
+#pragma region 构造
+public:
+    frozen_unordered_map() = default;
+
+    template<class InputIt>
+    requires std::derived_from<typename InputIt::iterator_category, anya::input_iterator_tag>
+    frozen_unordered_map(InputIt first, InputIt last,
+                         const hasher& hash = hasher(),
+                         const key_equal& equal = key_equal())
+        : hash_fcn(hash), equal_fcn(equal) {
+        using source_type = std::remove_reference_t<decltype(*first)>;
+        if constexpr (std::derived_from<anya::iter_category_t<InputIt>, anya::forward_iterator_tag> &&
+                      std::is_lvalue_reference_v<decltype(*first)>) {
+            // 元素在原处，只记下地址，直接复制到最终的位置
+            anya::vector<source_type*> source;
+            for (; first != last; ++first) source.push_back(std::addressof(*first));
+            build(source.size(), [&](size_t i) -> const Key& { return source[i]->first; },
+                                 [&](size_t i) -> source_type& { return *source[i]; });
+        }
+        else {
+            // 只能遍历一次，先把key和值放进可以移动的临时数组
+            anya::vector<std::pair<Key, T>> source;
+            for (; first != last; ++first) source.emplace_back(*first);
+            build(source.size(), [&](size_t i) -> const Key& { return source[i].first; },
+                                 [&](size_t i) -> std::pair<Key, T>&& { return std::move(source[i]); });
+        }
+    }
+
+    frozen_unordered_map(std::initializer_list<value_type> init,
+                         const hasher& hash = hasher(),
+                         const key_equal& equal = key_equal())
+        : hash_fcn(hash), equal_fcn(equal) {
+        auto first = init.begin();
+        build(init.size(), [&](size_t i) -> const Key& { return first[i].first; },
+                           [&](size_t i) -> const value_type& { return first[i]; });
+    }
+
+    frozen_unordered_map(const frozen_unordered_map& other)
+        : seeds(other.seeds), hash_fcn(other.hash_fcn), equal_fcn(other.equal_fcn) {
+        items = alloc.allocate(other.count_);
+        try {
+            anya::uninitialized_copy_n(other.items, other.count_, items);
+        }
+        catch (...) {
+            alloc.deallocate(items, other.count_);
+            throw;
+        }
+        count_ = other.count_;
+    }
+
+    frozen_unordered_map(frozen_unordered_map&& other) noexcept
+        : items(std::exchange(other.items, nullptr)), count_(std::exchange(other.count_, 0)),
+          seeds(std::move(other.seeds)), hash_fcn(std::move(other.hash_fcn)), equal_fcn(std::move(other.equal_fcn))
+    {}
+
+    ~frozen_unordered_map() { destroy_items(); }
+#pragma endregion
+
+
+#pragma region 赋值
+public:
+    frozen_unordered_map&
+    operator=(const frozen_unordered_map& other) {
+        if (this != &other) *this = frozen_unordered_map(other);
+        return *this;
+    }
+
+    frozen_unordered_map&
+    operator=(frozen_unordered_map&& other) noexcept {
+        if (this != &other) {
+            destroy_items();
+            items     = std::exchange(other.items, nullptr);
+            count_    = std::exchange(other.count_, 0);
+            seeds     = std::move(other.seeds);
+            hash_fcn  = std::move(other.hash_fcn);
+            equal_fcn = std::move(other.equal_fcn);
+        }
+        return *this;
+    }
+
+    allocator_type
+    get_allocator() const noexcept { return alloc; }
+#pragma endregion
+
+
+#pragma region 构造辅助函数
+private:
+    template<class KeyAt, class ValueAt>
+    void
+    build(size_t n, KeyAt key_at, ValueAt value_at) {
+        size_t bucket_count = n / bucket_load + 1;
+        anya::vector<uint64_t> hashes(n);
+        anya::vector<uint32_t> slots(n);
+        anya::vector<uint32_t> order(n), bucket_start(bucket_count + 1);
+        anya::vector<uint64_t> taken((n + 63) / 64);
+        seeds = anya::vector<uint32_t>(bucket_count);
+        build_perfect_hash(n, bucket_count, key_at, [this](const Key& key) { return hash_of(key); }, equal_fcn,
+                           seeds, slots, hashes, order, bucket_start, taken);
+        items = alloc.allocate(n);
+        size_t slot = 0;
+        try {
+            for (; slot < n; ++slot) alloc.construct(items + slot, value_at(slots[slot]));
+        }
+        catch (...) {
+            anya::destroy(items, items + slot);
+            alloc.deallocate(items, n);
+            items = nullptr;
+            throw;
+        }
+        count_ = n;
+    }
+
+    void
+    destroy_items() noexcept {
+        anya::destroy(items, items + count_);
+        alloc.deallocate(items, count_);
+        items = nullptr, count_ = 0;
+    }
+
+    // 用户的哈希函数可能只是恒等映射，再混合一次保证高位均匀
+    template<class K>
+    uint64_t
+    hash_of(const K& key) const { return hash_int(hash_fcn(key)); }
+#pragma endregion
+
+
+#pragma region 迭代器
+public:
+    const_iterator
+    begin() const noexcept { return items; }
+
+    const_iterator
+    cbegin() const noexcept { return items; }
+
+    const_iterator
+    end() const noexcept { return items + count_; }
+
+    const_iterator
+    cend() const noexcept { return items + count_; }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] bool
+    empty() const noexcept { return count_ == 0; }
+
+    [[nodiscard]] size_type
+    size() const noexcept { return count_; }
+
+    // 种子的个数
+    [[nodiscard]] size_type
+    bucket_count() const noexcept { return seeds.size(); }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    const_iterator
+    find(const Key& key) const { return find_by_key(key); }
+
+    template<class K>
+    requires is_transparent
+    const_iterator
+    find(const K& key) const { return find_by_key(key); }
+
+    bool
+    contains(const Key& key) const { return find(key) != end(); }
+
+    template<class K>
+    requires is_transparent
+    bool
+    contains(const K& key) const { return find(key) != end(); }
+
+    size_type
+    count(const Key& key) const { return contains(key); }
+
+    template<class K>
+    requires is_transparent
+    size_type
+    count(const K& key) const { return contains(key); }
+
+    const T&
+    at(const Key& key) const {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("frozen_unordered_map has not this key");
+        return it->second;
+    }
+
+private:
+    template<class K>
+    const_iterator
+    find_by_key(const K& key) const {
+        if (count_ == 0) return end();
+        size_t slot = perfect_hash_find(hash_of(key), seeds, seeds.size(), count_);
+        return equal_fcn(items[slot].first, key) ? items + slot : end();
+    }
+#pragma endregion
+
+
+#pragma region 观察器
+public:
+    hasher
+    hash_function() const { return hash_fcn; }
+
+    key_equal
+    key_eq() const { return equal_fcn; }
+#pragma endregion
+
+
+#pragma region 友元比较函数
+public:
+    friend bool
+    operator==(const frozen_unordered_map& lhs, const frozen_unordered_map& rhs) {
+        if (lhs.size() != rhs.size()) return false;
+        for (auto& [key, value] : lhs) {
+            auto it = rhs.find(key);
+            if (it == rhs.end() || !(it->second == value)) return false;
+        }
+        return true;
+    }
+#pragma endregion
+};
+
+}
+
+#endif //ANYA_STL_FROZEN_UNORDERED_MAP_HPP
@@ -0,0 +1,479 @@
+//
+// Created by Anya on 2023/8/18.
+//
+
+#ifndef ANYA_STL_HASH_IMAGE_HPP
+#define ANYA_STL_HASH_IMAGE_HPP
+
+#include "container/vector.hpp"
+#include "container/built-in/hash_policy.hpp"
+#include "functional/hash.hpp"
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if __has_include(<sys/mman.h>)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define ANYA_HASH_IMAGE_MMAP 1
+#endif
+
+namespace anya {
+
+// 哈希表的扁平二进制镜像
+// 把一张只读的查找表写成一个文件，之后的进程直接 mmap 这个文件，在映射的页面上查找，不需要反序列化也不需要逐个插入
+// 镜像中只有偏移量没有指针，映射到任何地址都能直接使用
+//
+// 文件布局（每一段都按64字节对齐）：
+//   header   魔数、格式版本、键值类型的大小、元素个数、各段的偏移量和校验和
+//   buckets  bucket_count + 1 个 uint64_t，第i个桶的元素是 entries[buckets[i], buckets[i + 1])
+//   entries  按桶排好的 {hash, key, mapped}
+//   arena    字符串的字节，entries 中的字符串只保存 {offset, size}
+// 校验和覆盖 header 之后的全部内容；各字段按本机字节序存放，字节序不同的机器上版本号对不上，会被拒绝
+
+#pragma region 存储类型
+// 可以写入镜像的类型：可平凡复制的类型原样存放，std::string 存放为字符串区中的 {offset, size}
+template<class T>
+concept image_storable = std::is_trivially_copyable_v<T> || std::same_as<T, std::string>;
+
+struct image_string {
+    uint64_t offset;
+    uint64_t size;
+};
+
+template<image_storable T>
+struct image_traits {
+    using stored_type = T;
+    using lookup_type = const T&;   // 查找时接受的key
+    using result_type = const T*;   // 查找的结果，可以像指针一样判空和解引用
+
+    constexpr static bool is_string = false;
+
+    static const T&
+    view(const stored_type& stored, const char*) noexcept { return stored; }
+
+    static result_type
+    result(const stored_type& stored, const char*) noexcept { return &stored; }
+};
+
+template<>
+struct image_traits<std::string> {
+    using stored_type = image_string;
+    using lookup_type = std::string_view;
+    using result_type = std::optional<std::string_view>;
+
+    constexpr static bool is_string = true;
+
+    static std::string_view
+    view(const stored_type& stored, const char* arena) noexcept { return {arena + stored.offset, stored.size}; }
+
+    static result_type
+    result(const stored_type& stored, const char* arena) noexcept { return view(stored, arena); }
+};
+
+template<class Key, class T>
+struct image_entry {
+    uint64_t                                hash;
+    typename image_traits<Key>::stored_type key;
+    typename image_traits<T>::stored_type   mapped;
+};
+#pragma endregion
+
+
+#pragma region 文件头与校验和
+struct hash_image_header {
+    constexpr static char     magic_bytes[8] = {'A', 'N', 'Y', 'A', 'H', 'I', 'M', 'G'};
+    constexpr static uint32_t current_version = 1;
+    constexpr static uint32_t string_key      = 1;   // flags：key是字符串
+    constexpr static uint32_t string_mapped   = 2;   // flags：值是字符串
+    constexpr static size_t   alignment       = 64;
+
+    char     magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t key_size;      // 存储类型的大小，用来发现读写两端的类型不一致
+    uint32_t mapped_size;
+    uint32_t entry_size;
+    uint32_t reserved;
+    uint64_t hash_check;    // 哈希函数作用在固定key上的结果，用来发现读写两端的哈希函数不一致
+    uint64_t size;
+    uint64_t bucket_count;
+    uint64_t buckets_offset;
+    uint64_t entries_offset;
+    uint64_t arena_offset;
+    uint64_t arena_size;
+    uint64_t file_size;
+    uint64_t checksum;      // header 之后全部内容的校验和
+};
+
+// 把n上调至alignment的倍数
+constexpr uint64_t
+image_align(uint64_t n) { return (n + hash_image_header::alignment - 1) & ~uint64_t(hash_image_header::alignment - 1); }
+
+// 流式的64位校验和，四路独立累加，每次处理32字节，多GB的镜像也能以接近内存带宽的速度校验
+// 各段都按64字节对齐填充，所以每次 update 的长度总是32的倍数
+class image_checksum {
+private:
+    constexpr static uint64_t prime1 = 0x9E3779B185EBCA87ull;
+    constexpr static uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+
+    uint64_t lanes[4] = {prime1, prime2, ~prime1, ~prime2};
+    uint64_t length   = 0;
+
+    static uint64_t
+    round(uint64_t acc, uint64_t word) noexcept { return std::rotl(acc + word * prime2, 31) * prime1; }
+
+public:
+    void
+    update(const void* data, size_t n) noexcept {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i + 32 <= n; i += 32) {
+            uint64_t words[4];
+            std::memcpy(words, bytes + i, sizeof(words));
+            for (int lane = 0; lane < 4; ++lane) lanes[lane] = round(lanes[lane], words[lane]);
+        }
+        length += n;
+    }
+
+    [[nodiscard]] uint64_t
+    digest() const noexcept {
+        uint64_t result = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        result = (result ^ length) * prime1;
+        return result ^ (result >> 29);
+    }
+};
+
+// 写入或打开镜像失败
+class hash_image_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// 哈希函数作用在固定key上的结果，key不能默认构造时不做检查
+template<class Key, class Hash>
+uint64_t
+image_hash_check(const Hash& hash) {
+    if constexpr (std::same_as<Key, std::string>) return hash(std::string_view("anya"));
+    else if constexpr (std::is_default_constructible_v<Key>) return hash(Key{});
+    else return 0;
+}
+
+template<class Key, class T>
+hash_image_header
+make_image_header() {
+    hash_image_header header{};
+    std::memcpy(header.magic, hash_image_header::magic_bytes, sizeof(header.magic));
+    header.version     = hash_image_header::current_version;
+    header.flags       = (image_traits<Key>::is_string ? hash_image_header::string_key : 0)
+                       | (image_traits<T>::is_string ? hash_image_header::string_mapped : 0);
+    header.key_size    = sizeof(typename image_traits<Key>::stored_type);
+    header.mapped_size = sizeof(typename image_traits<T>::stored_type);
+    header.entry_size  = sizeof(image_entry<Key, T>);
+    return header;
+}
+#pragma endregion
+
+
+#pragma region 写入
+// 把 map 中的全部元素写成镜像文件，map 可以是任何遍历时给出 {first, second} 的容器
+// 桶数取不小于元素个数的2的幂，下标与 power2_rehash_policy 相同；失败时抛出 hash_image_error
+template<class Map, class Hash = anya::hash<typename Map::key_type>>
+requires image_storable<typename Map::key_type> && image_storable<typename Map::mapped_type>
+void
+write_hash_image(const Map& map, const char* path, const Hash& hash = Hash()) {
+    using Key    = typename Map::key_type;
+    using T      = typename Map::mapped_type;
+    using entry  = image_entry<Key, T>;
+    using policy = anya::power2_rehash_policy;
+
+    hash_image_header header = make_image_header<Key, T>();
+    header.hash_check = image_hash_check<Key>(hash);
+
+    // 第一遍：算出每个元素的哈希值、每个桶的元素个数和字符串的总长度
+    anya::vector<uint64_t> codes;
+    codes.reserve(map.size());
+    uint64_t arena_size = 0;
+    for (const auto& [key, mapped] : map) {
+        codes.push_back(hash(key));
+        if constexpr (image_traits<Key>::is_string) arena_size += key.size();
+        if constexpr (image_traits<T>::is_string) arena_size += mapped.size();
+    }
+    size_t bucket_count = policy::next_bucket_count(codes.size());
+    anya::vector<uint64_t> buckets(bucket_count + 1, 0);
+    for (uint64_t code : codes) ++buckets[policy::index(code, bucket_count) + 1];
+    for (size_t i = 0; i < bucket_count; ++i) buckets[i + 1] += buckets[i];
+
+    // 第二遍：把元素放进各自的桶，字符串依次追加到字符串区
+    anya::vector<entry>    entries(codes.size());
+    anya::vector<char>     arena(image_align(arena_size), 0);
+    anya::vector<uint64_t> cursor(buckets.begin(), buckets.end() - 1);
+    uint64_t arena_used = 0;
+    auto store = [&]<class U>(const U& value) {
+        if constexpr (std::same_as<U, std::string>) {
+            if (!value.empty()) std::memcpy(arena.data() + arena_used, value.data(), value.size());
+            image_string result{arena_used, value.size()};
+            arena_used += value.size();
+            return result;
+        }
+        else return value;
+    };
+    size_t index = 0;
+    for (const auto& [key, mapped] : map) {
+        uint64_t code = codes[index++];
+        entry& target = entries[cursor[policy::index(code, bucket_count)]++];
+        std::memset(&target, 0, sizeof(entry));  // 填充字节也写成0，相同的表总是得到相同的镜像
+        target.hash   = code;
+        target.key    = store(key);
+        target.mapped = store(mapped);
+    }
+
+    // 各段的偏移量
+    uint64_t buckets_bytes = buckets.size() * sizeof(uint64_t);
+    uint64_t entries_bytes = entries.size() * sizeof(entry);
+    header.size           = entries.size();
+    header.bucket_count   = bucket_count;
+    header.buckets_offset = image_align(sizeof(hash_image_header));
+    header.entries_offset = header.buckets_offset + image_align(buckets_bytes);
+    header.arena_offset   = header.entries_offset + image_align(entries_bytes);
+    header.arena_size     = arena_size;
+    header.file_size      = header.arena_offset + arena.size();
+
+    // 依次写出各段，边写边累加校验和，最后回到开头写入 header
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) throw hash_image_error(std::string("cannot create hash image: ") + path);
+    image_checksum checksum;
+    const char zeros[hash_image_header::alignment] = {};
+    bool ok = true;
+    // 空段的 data 可能是空指针，既不写出也不计入校验和
+    auto write = [&](const void* data, uint64_t n) {
+        if (n == 0) return;
+        ok = ok && std::fwrite(data, 1, n, file) == n;
+        uint64_t padding = image_align(n) - n;
+        ok = ok && std::fwrite(zeros, 1, padding, file) == padding;
+    };
+    auto write_section = [&](const void* data, uint64_t n) {
+        if (n == 0) return;
+        write(data, n);
+        checksum.update(data, n - n % 32);
+        // 末尾不足32字节的部分连同填充的0一起计入
+        unsigned char tail[hash_image_header::alignment] = {};
+        if (n % 32 != 0) std::memcpy(tail, static_cast<const char*>(data) + (n - n % 32), n % 32);
+        checksum.update(tail, image_align(n) - (n - n % 32));
+    };
+    write(&header, sizeof(header));
+    write_section(buckets.data(), buckets_bytes);
+    write_section(entries.data(), entries_bytes);
+    write_section(arena.data(), arena.size());
+    header.checksum = checksum.digest();
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0;
+    ok = ok && std::fwrite(&header, 1, sizeof(header), file) == sizeof(header);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) throw hash_image_error(std::string("cannot write hash image: ") + path);
+}
+#pragma endregion
+
+
+#ifdef ANYA_HASH_IMAGE_MMAP
+#pragma region 只读视图
+// 以只读方式映射镜像文件并直接在映射的页面上查找
+// 打开时只检查文件头，verify 为 true 时还会读一遍整个文件核对校验和；页面在第一次访问时才由系统读入
+// Key、T、Hash 必须与写入时一致，类型大小或哈希函数不一致时打开会失败
+template<
+    class Key,
+    class T,
+    class Hash     = anya::hash<Key>,
+    class KeyEqual = std::equal_to<>>
+requires image_storable<Key> && image_storable<T>
+class hash_image_view {
+public:
+    using key_type    = Key;
+    using mapped_type = T;
+    using size_type   = size_t;
+    using hasher      = Hash;
+    using key_equal   = KeyEqual;
+    using lookup_type = typename image_traits<Key>::lookup_type;
+    using result_type = typename image_traits<T>::result_type;
+
+private:
+    using entry  = image_entry<Key, T>;
+    using policy = anya::power2_rehash_policy;
+
+    const char*     base = nullptr;    // 映射的起始地址
+    size_t          length = 0;
+    const uint64_t* buckets = nullptr;
+    const entry*    entries = nullptr;
+    const char*     arena = nullptr;
+    size_t          elements = 0;
+    size_t          buckets_size = 0;
+    hasher          hash_fcn{};
+    key_equal       equal_fcn{};
+
+#pragma region 构造 && 析构
+public:
+    explicit hash_image_view(const char* path, bool verify = true,
+                             const hasher& hash = hasher(),
+                             const key_equal& equal = key_equal())
+        : hash_fcn(hash), equal_fcn(equal) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) throw hash_image_error(std::string("cannot open hash image: ") + path);
+        struct stat info{};
+        if (::fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(hash_image_header)) {
+            ::close(fd);
+            throw hash_image_error(std::string("hash image is truncated: ") + path);
+        }
+        length = info.st_size;
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) throw hash_image_error(std::string("cannot map hash image: ") + path);
+        base = static_cast<const char*>(address);
+        try {
+            check(verify);
+        }
+        catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    hash_image_view(const hash_image_view&) = delete;
+
+    hash_image_view(hash_image_view&& other) noexcept { swap(other); }
+
+    hash_image_view&
+    operator=(const hash_image_view&) = delete;
+
+    hash_image_view&
+    operator=(hash_image_view&& other) noexcept {
+        hash_image_view(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~hash_image_view() { unmap(); }
+
+    void
+    swap(hash_image_view& other) noexcept {
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+        std::swap(buckets, other.buckets);
+        std::swap(entries, other.entries);
+        std::swap(arena, other.arena);
+        std::swap(elements, other.elements);
+        std::swap(buckets_size, other.buckets_size);
+        std::swap(hash_fcn, other.hash_fcn);
+        std::swap(equal_fcn, other.equal_fcn);
+    }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] bool
+    empty() const noexcept { return elements == 0; }
+
+    [[nodiscard]] size_type
+    size() const noexcept { return elements; }
+
+    [[nodiscard]] size_type
+    bucket_count() const noexcept { return buckets_size; }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    // 找到时返回指向映射页面中值的指针（字符串为 string_view），否则返回空
+    [[nodiscard]] result_type
+    find(lookup_type key) const {
+        const entry* target = find_entry(key);
+        if (target == nullptr) return result_type{};
+        return image_traits<T>::result(target->mapped, arena);
+    }
+
+    [[nodiscard]] bool
+    contains(lookup_type key) const { return find_entry(key) != nullptr; }
+
+    // 按桶的顺序对每个元素调用 func(key, mapped)，字符串以 string_view 给出
+    template<class F>
+    void
+    for_each(F&& func) const {
+        for (size_t i = 0; i < elements; ++i) {
+            func(image_traits<Key>::view(entries[i].key, arena), image_traits<T>::view(entries[i].mapped, arena));
+        }
+    }
+#pragma endregion
+
+
+#pragma region 工具函数
+private:
+    const entry*
+    find_entry(lookup_type key) const {
+        uint64_t code = hash_fcn(key);
+        size_t index = policy::index(code, buckets_size);
+        for (uint64_t i = buckets[index], last = buckets[index + 1]; i < last; ++i) {
+            if (entries[i].hash == code && equal_fcn(image_traits<Key>::view(entries[i].key, arena), key)) {
+                return entries + i;
+            }
+        }
+        return nullptr;
+    }
+
+    void
+    unmap() noexcept {
+        if (base) ::munmap(const_cast<char*>(base), length);
+        base = nullptr;
+    }
+
+    // 检查文件头与模板参数是否一致、各段是否都在文件内，以及可选的校验和
+    void
+    check(bool verify) {
+        hash_image_header header;
+        std::memcpy(&header, base, sizeof(header));
+        hash_image_header expected = make_image_header<Key, T>();
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0)
+            throw hash_image_error("not a hash image");
+        if (header.version != expected.version)
+            throw hash_image_error("unsupported hash image version " + std::to_string(header.version));
+        if (header.flags != expected.flags || header.key_size != expected.key_size ||
+            header.mapped_size != expected.mapped_size || header.entry_size != expected.entry_size)
+            throw hash_image_error("hash image was written with different key or mapped types");
+        if (header.hash_check != image_hash_check<Key>(hash_fcn))
+            throw hash_image_error("hash image was written with a different hash function");
+
+        uint64_t buckets_bytes = (header.bucket_count + 1) * sizeof(uint64_t);
+        uint64_t entries_bytes = header.size * sizeof(entry);
+        bool valid = header.file_size == length &&
+                     std::has_single_bit(header.bucket_count) && header.bucket_count >= 2 &&
+                     header.buckets_offset == image_align(sizeof(hash_image_header)) &&
+                     header.entries_offset == header.buckets_offset + image_align(buckets_bytes) &&
+                     header.arena_offset == header.entries_offset + image_align(entries_bytes) &&
+                     header.file_size == header.arena_offset + image_align(header.arena_size);
+        if (!valid) throw hash_image_error("hash image is truncated or corrupted");
+
+        if (verify) {
+            image_checksum checksum;
+            checksum.update(base + header.buckets_offset, length - header.buckets_offset);
+            if (checksum.digest() != header.checksum) throw hash_image_error("hash image checksum mismatch");
+        }
+
+        buckets      = reinterpret_cast<const uint64_t*>(base + header.buckets_offset);
+        entries      = reinterpret_cast<const entry*>(base + header.entries_offset);
+        arena        = base + header.arena_offset;
+        elements     = header.size;
+        buckets_size = header.bucket_count;
+        if (buckets[buckets_size] != elements) throw hash_image_error("hash image is truncated or corrupted");
+    }
+#pragma endregion
+};
+#pragma endregion
+#endif
+
+}
+
+#endif //ANYA_STL_HASH_IMAGE_HPP
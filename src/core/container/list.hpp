@@ -6,6 +6,7 @@
 #define ANYA_STL_LIST_HPP
 
 #include "allocator/memory.hpp"
+#include "allocator/node_slab.hpp"
 #include "iterator/iterator.hpp"
 #include "algorithm/algorithm.h"
 
@@ -120,7 +121,7 @@ public:
     using const_reference = const T&;
     using size_type       = size_t;
     using difference_type = ptrdiff_t;
-    using allocator_type  = anya::allocator<T>;
+    using allocator_type  = Allocator;
 
 public:
     using iterator               = list_iterator<value_type>;
@@ -129,12 +130,15 @@ public:
     using const_reverse_iterator = anya::reverse_iterator<const_iterator>;
 
 private:
-    using base_alloc_type = anya::allocator<list_base_node>;
-    using node_alloc_type = anya::allocator<list_node<T>>;
+    using base_alloc_type = typename Allocator::template rebind<list_base_node>::other;
+    using node_alloc_type = anya::node_allocator_t<Allocator, list_node<T>>;
+
+    // Allocator 为 slab_allocator 时结点来自本链表私有的 node_slab
+    constexpr static bool slab_nodes = anya::is_slab_allocator<Allocator>::value;
 
     allocator_type alloc{};      // 普通内存分配器
     base_alloc_type base_alloc;  // base节点分配器
-    node_alloc_type node_alloc;  // 标准节点分配器
+    node_alloc_type node_alloc;  // 标准节点分配器，可能是私有的结点池
     list_root root{};            // 虚拟根节点资源
 
 #pragma region 构造 && 析构
@@ -196,7 +200,8 @@ public:
     list&
     operator=(list&& other) noexcept {
         if (&other == this) return *this;
-        move_storage(other);
+        // 原有结点随临时对象析构，结点池也一并交换
+        list(std::move(other)).swap(*this);
         return *this;
     }
 
@@ -474,6 +479,7 @@ public:
     void
     swap(list& other) noexcept {
         std::swap(root, other.root);
+        std::swap(node_alloc, other.node_alloc);
     }
 
 #pragma endregion
@@ -516,9 +522,11 @@ public:
                 insert_it = insert_front(insert_it, (input_it++).current);
             }
         }
-        other.root.next = other.root.tail;
+        other.root.next = other.root.tail, other.root.tail->prev = &other.root;
         this->root.size += other.root.size;
         other.root.size = 0;
+        // other 的结点都已经接入本链表，它们所在的块也归本链表所有
+        if constexpr (slab_nodes) node_alloc.adopt(other.node_alloc);
     }
 
     void
@@ -550,14 +558,32 @@ public:
     void
     splice(const_iterator pos, list&& other,
            const_iterator first, const_iterator last) {
-        if (first == last) return;
-        size_t len = anya::distance(first, last);
-        other.root.size -= len;
-        list_base_node* pre = first.current->prev;
-        list_base_node* next = last.current;
+        // pos 等于 first 时元素已经在目标位置上
+        if (first == last || pos == first) return;
+        bool whole = first == other.cbegin() && last == other.cend();
+        if constexpr (slab_nodes) {
+            // 结点属于 other 的结点池，只有整个链表移过来时才能连同结点池一起接管，否则逐个移动元素
+            if (&other != this && !whole) {
+                while (first != last) {
+                    auto* node = reinterpret_cast<list_node<T>*>((first++).current);
+                    insert_front(pos, make_node(std::move(node->data)));
+                    connect(node->prev, node->next);
+                    other.destroy_node(node);
+                }
+                return;
+            }
+        }
+        // 只修改指针，不分配也不复制元素；同一个链表内移动时元素个数不变
+        size_t len = &other == this ? 0 : whole ? other.size() : anya::distance(first, last);
+        list_base_node* head = first.current;
+        list_base_node* tail = last.current->prev;
         // 缝合other链表
-        connect(pre, next);
-        insert(pos, first, last);
+        connect(head->prev, last.current);
+        connect(pos.current->prev, head);
+        connect(tail, pos.current);
+        other.root.size -= len;
+        this->root.size += len;
+        if constexpr (slab_nodes) if (&other != this) node_alloc.adopt(other.node_alloc);
     }
 
     size_type
@@ -709,9 +735,20 @@ private:
         node->prev = &root;
     };
 
-    // 析构并回收所有链表节点
+    // 析构并回收所有链表节点；使用私有结点池时整块归还，元素可以平凡析构时不遍历结点
     void
     destroy_all() {
+        if constexpr (slab_nodes) {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (list_base_node* cur = root.next; cur != root.tail; cur = cur->next) {
+                    anya::destroy_at(reinterpret_cast<list_node<T>*>(cur));
+                }
+            }
+            node_alloc.release();
+            root.next = root.tail, root.tail->prev = &root;
+            root.size = 0;
+            return;
+        }
         list_base_node* cur = root.next;
         list_base_node* next;
         while (cur != root.tail) {
@@ -719,13 +756,13 @@ private:
             destroy_node(cur);
             cur = next;
         }
-        root.next = root.tail;
+        root.next = root.tail, root.tail->prev = &root;
     }
 
     // 析构并回收单个链表节点
     void
     destroy_node(list_base_node *node) {
-        node_alloc.template destroy(reinterpret_cast<list_node<T>*>(node));
+        anya::destroy_at(reinterpret_cast<list_node<T>*>(node));
         node_alloc.deallocate(reinterpret_cast<list_node<T>*>(node), 1);
         --root.size;
     }
@@ -743,6 +780,7 @@ private:
     // 移动对象
     void move_storage(list& other) {
         root = other.root, other.root = {}, other.init_end();
+        std::swap(node_alloc, other.node_alloc);
     }
 
 #pragma endregion
@@ -818,6 +856,13 @@ swap(anya::list<T, Alloc>& lhs, anya::list<T, Alloc>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
+// 删除所有满足 pred 的元素，返回删除的个数；链表删除结点不移动其他元素，直接使用 remove_if
+template<class T, class Alloc, class UnaryPredicate>
+typename anya::list<T, Alloc>::size_type
+erase_if(anya::list<T, Alloc>& c, UnaryPredicate pred) {
+    return c.remove_if(pred);
+}
+
 }
 
 #endif //ANYA_STL_LIST_HPP
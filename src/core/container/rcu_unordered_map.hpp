@@ -0,0 +1,346 @@
+//
+// Created by Anya on 2023/8/12.
+//
+
+#ifndef ANYA_STL_RCU_UNORDERED_MAP_HPP
+#define ANYA_STL_RCU_UNORDERED_MAP_HPP
+
+#include "container/vector.hpp"
+#include "container/built-in/hash_policy.hpp"
+#include "mutex/epoch.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace anya {
+
+// 读多写少的并发哈希表
+// 读者不加锁：查找只有原子读和写自己线程的epoch记录，是wait-free的（线程第一次读时需要注册一次记录）
+// 写者之间用互斥锁串行，修改通过原子指针发布：插入把新结点挂到链头，修改值时用新结点替换旧结点，
+// 扩容时复制出整张新表再替换表指针；被替换下来的结点和表交给 epoch_domain，等所有可能看到它们的读者离开后再释放
+// 结点布局与 hashtable 相同（可选的哈希值缓存 + next + value），只是 next 换成了原子指针
+template<
+    class Key,
+    class T,
+    class Hash         = anya::hash<Key>,
+    class KeyEqual     = std::equal_to<Key>,
+    class RehashPolicy = anya::default_rehash_policy>
+class rcu_unordered_map {
+public:
+    using key_type      = Key;
+    using mapped_type   = T;
+    using value_type    = std::pair<const Key, T>;
+    using size_type     = size_t;
+    using hasher        = Hash;
+    using key_equal     = KeyEqual;
+    using rehash_policy = RehashPolicy;
+
+private:
+    constexpr static bool cache_hash_code = !anya::is_fast_hash<Hash>::value;
+
+    struct node : anya::hash_code_storage<cache_hash_code> {
+        std::atomic<node*> next;
+        value_type value;
+
+        template<class... Args>
+        explicit node(node* link, Args&&... args) : next(link), value(std::forward<Args>(args)...) {}
+    };
+
+    struct bucket_array {
+        size_t count;
+        std::unique_ptr<std::atomic<node*>[]> heads;
+
+        explicit bucket_array(size_t n) : count(n), heads(new std::atomic<node*>[n]) {
+            for (size_t i = 0; i < n; ++i) heads[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        // 释放表和表中剩余的全部结点
+        ~bucket_array() {
+            for (size_t i = 0; i < count; ++i) {
+                node* current = heads[i].load(std::memory_order_relaxed);
+                while (current) {
+                    node* next = current->next.load(std::memory_order_relaxed);
+                    delete current;
+                    current = next;
+                }
+            }
+        }
+    };
+
+    // 等待回收的对象
+    struct retired {
+        void*    ptr;
+        void     (*deleter)(void*);
+        uint64_t epoch;
+    };
+
+    // 不同表的写者可能在不同的线程上同时回收，不使用全局的内存池
+    using retired_container = anya::vector<retired, anya::malloc_allocator<retired>>;
+
+    hasher                     hash_fcn{};
+    key_equal                  equal_fcn{};
+    std::atomic<bucket_array*> table;
+    std::atomic<size_t>        elements{};
+    std::mutex                 writer;         // 写者之间互斥
+    retired_container          retired_list;   // 由writer保护
+
+    constexpr static size_t default_size = 11;
+
+#pragma region 构造 && 析构
+public:
+    rcu_unordered_map() : rcu_unordered_map(default_size) {}
+
+    explicit rcu_unordered_map(size_t bucket_count,
+                               const hasher& hash = hasher(),
+                               const key_equal& equal = key_equal())
+        : hash_fcn(hash), equal_fcn(equal),
+          table(new bucket_array(RehashPolicy::next_bucket_count(bucket_count)))
+    {}
+
+    rcu_unordered_map(const rcu_unordered_map&) = delete;
+
+    rcu_unordered_map&
+    operator=(const rcu_unordered_map&) = delete;
+
+    // 析构时不能再有读者
+    ~rcu_unordered_map() {
+        for (auto& item : retired_list) item.deleter(item.ptr);
+        delete table.load(std::memory_order_relaxed);
+    }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] bool
+    empty() const noexcept { return size() == 0; }
+
+    [[nodiscard]] size_type
+    size() const noexcept { return elements.load(std::memory_order_relaxed); }
+
+    [[nodiscard]] size_type
+    bucket_count() const noexcept { return table.load(std::memory_order_acquire)->count; }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    // wait-free，返回值的拷贝
+    [[nodiscard]] std::optional<T>
+    find(const Key& key) const {
+        anya::epoch_guard guard;
+        if (const node* current = find_node(key)) return current->value.second;
+        return std::nullopt;
+    }
+
+    [[nodiscard]] bool
+    contains(const Key& key) const {
+        anya::epoch_guard guard;
+        return find_node(key) != nullptr;
+    }
+
+    // wait-free，在读临界区内对值调用 func(const T&)，避免拷贝较大的值；返回key是否存在
+    template<class F>
+    bool
+    visit(const Key& key, F&& func) const {
+        anya::epoch_guard guard;
+        const node* current = find_node(key);
+        if (current) std::forward<F>(func)(current->value.second);
+        return current != nullptr;
+    }
+
+    // 在读临界区内遍历当前的表，遍历期间的修改可能看得到也可能看不到
+    template<class F>
+    void
+    for_each(F&& func) const {
+        anya::epoch_guard guard;
+        const bucket_array* current = table.load(std::memory_order_acquire);
+        for (size_t i = 0; i < current->count; ++i) {
+            for (const node* ptr = current->heads[i].load(std::memory_order_acquire); ptr;
+                 ptr = ptr->next.load(std::memory_order_acquire)) {
+                func(ptr->value);
+            }
+        }
+    }
+#pragma endregion
+
+
+#pragma region 修改器
+public:
+    // key不存在时以 (key, args...) 构造元素，返回是否插入
+    template<class... Args>
+    bool
+    emplace(const Key& key, Args&&... args) {
+        std::lock_guard lock(writer);
+        size_t code = hash_fcn(key);
+        if (find_node(key, code)) return false;
+        insert_node(key, code, std::forward<Args>(args)...);
+        return true;
+    }
+
+    bool
+    insert(const value_type& value) { return emplace(value.first, value.second); }
+
+    // key存在时用新结点替换旧结点，读者要么看到旧值要么看到新值；返回是否插入
+    template<class M>
+    bool
+    insert_or_assign(const Key& key, M&& obj) {
+        std::lock_guard lock(writer);
+        size_t code = hash_fcn(key);
+        bucket_array* current = table.load(std::memory_order_relaxed);
+        std::atomic<node*>* link = &current->heads[RehashPolicy::index(code, current->count)];
+        node* exist = link->load(std::memory_order_relaxed);
+        while (exist && !node_equals(exist, key, code)) {
+            link = &exist->next;
+            exist = link->load(std::memory_order_relaxed);
+        }
+        if (exist == nullptr) {
+            insert_node(key, code, std::forward<M>(obj));
+            return true;
+        }
+        node* replacement = new node(exist->next.load(std::memory_order_relaxed), key, std::forward<M>(obj));
+        store_hash_code(replacement, code);
+        link->store(replacement, std::memory_order_release);
+        retire(exist, &delete_node);
+        return false;
+    }
+
+    size_type
+    erase(const Key& key) {
+        std::lock_guard lock(writer);
+        size_t code = hash_fcn(key);
+        bucket_array* current = table.load(std::memory_order_relaxed);
+        std::atomic<node*>* link = &current->heads[RehashPolicy::index(code, current->count)];
+        node* exist = link->load(std::memory_order_relaxed);
+        while (exist && !node_equals(exist, key, code)) {
+            link = &exist->next;
+            exist = link->load(std::memory_order_relaxed);
+        }
+        if (exist == nullptr) return 0;
+        // 被摘下的结点的next保持不变，正停在它上面的读者仍然能走完剩下的链
+        link->store(exist->next.load(std::memory_order_relaxed), std::memory_order_release);
+        elements.fetch_sub(1, std::memory_order_relaxed);
+        retire(exist, &delete_node);
+        return 1;
+    }
+
+    // 换上一张同样大小的空表，旧表整体延迟回收
+    void
+    clear() {
+        std::lock_guard lock(writer);
+        bucket_array* old = table.load(std::memory_order_relaxed);
+        table.store(new bucket_array(old->count), std::memory_order_release);
+        elements.store(0, std::memory_order_relaxed);
+        retire(old, &delete_table);
+    }
+
+    // 尝试回收已经没有读者的对象，返回仍在等待回收的个数
+    size_type
+    reclaim() {
+        std::lock_guard lock(writer);
+        return reclaim_retired();
+    }
+#pragma endregion
+
+
+#pragma region 工具函数
+private:
+    static void
+    delete_node(void* ptr) { delete static_cast<node*>(ptr); }
+
+    static void
+    delete_table(void* ptr) { delete static_cast<bucket_array*>(ptr); }
+
+    void
+    store_hash_code(node* ptr, size_t code) {
+        if constexpr (cache_hash_code) ptr->hash_code = code;
+    }
+
+    [[nodiscard]] size_t
+    node_hash_code(const node* ptr) const {
+        if constexpr (cache_hash_code) return ptr->hash_code;
+        else return hash_fcn(ptr->value.first);
+    }
+
+    [[nodiscard]] bool
+    node_equals(const node* ptr, const Key& key, size_t code) const {
+        if constexpr (cache_hash_code) {
+            if (ptr->hash_code != code) return false;
+        }
+        return equal_fcn(ptr->value.first, key);
+    }
+
+    // 读者和写者共用的查找，读者必须处于读临界区内
+    const node*
+    find_node(const Key& key) const { return find_node(key, hash_fcn(key)); }
+
+    const node*
+    find_node(const Key& key, size_t code) const {
+        const bucket_array* current = table.load(std::memory_order_acquire);
+        const node* ptr = current->heads[RehashPolicy::index(code, current->count)].load(std::memory_order_acquire);
+        while (ptr && !node_equals(ptr, key, code)) ptr = ptr->next.load(std::memory_order_acquire);
+        return ptr;
+    }
+
+    // 由调用者保证持有写锁且key不存在；先完整构造结点再发布到链头
+    template<class... Args>
+    void
+    insert_node(const Key& key, size_t code, Args&&... args) {
+        grow();
+        bucket_array* current = table.load(std::memory_order_relaxed);
+        std::atomic<node*>& head = current->heads[RehashPolicy::index(code, current->count)];
+        node* ptr = new node(head.load(std::memory_order_relaxed), std::piecewise_construct,
+                             std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        store_hash_code(ptr, code);
+        head.store(ptr, std::memory_order_release);
+        elements.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 再插入一个元素就超载时，复制出一张两倍大小的新表后替换表指针，读者在旧表上的遍历不受影响
+    void
+    grow() {
+        bucket_array* old = table.load(std::memory_order_relaxed);
+        size_t count = size() + 1;
+        if (count <= old->count) return;
+        auto fresh = new bucket_array(RehashPolicy::next_bucket_count(anya::max(count, old->count * 2)));
+        for (size_t i = 0; i < old->count; ++i) {
+            for (node* ptr = old->heads[i].load(std::memory_order_relaxed); ptr;
+                 ptr = ptr->next.load(std::memory_order_relaxed)) {
+                size_t code = node_hash_code(ptr);
+                std::atomic<node*>& head = fresh->heads[RehashPolicy::index(code, fresh->count)];
+                node* copy = new node(head.load(std::memory_order_relaxed), ptr->value);
+                store_hash_code(copy, code);
+                head.store(copy, std::memory_order_relaxed);
+            }
+        }
+        table.store(fresh, std::memory_order_release);
+        retire(old, &delete_table);
+    }
+
+    // 摘下的对象记下推进后的epoch，顺便回收已经安全的对象
+    void
+    retire(void* ptr, void (*deleter)(void*)) {
+        retired_list.push_back({ptr, deleter, anya::epoch_domain::instance().advance()});
+        reclaim_retired();
+    }
+
+    size_t
+    reclaim_retired() {
+        if (retired_list.empty()) return 0;
+        uint64_t safe = anya::epoch_domain::instance().min_active();
+        size_t kept = 0;
+        for (size_t i = 0; i < retired_list.size(); ++i) {
+            retired item = retired_list[i];
+            if (item.epoch <= safe) item.deleter(item.ptr);
+            else retired_list[kept++] = item;
+        }
+        while (retired_list.size() > kept) retired_list.pop_back();
+        return kept;
+    }
+#pragma endregion
+};
+
+}
+
+#endif //ANYA_STL_RCU_UNORDERED_MAP_HPP
@@ -0,0 +1,542 @@
+//
+// Created by Anya on 2023/8/26.
+//
+
+#ifndef ANYA_STL_STRING_UNORDERED_MAP_HPP
+#define ANYA_STL_STRING_UNORDERED_MAP_HPP
+
+#include "container/vector.hpp"
+#include "container/built-in/hash_policy.hpp"
+#include "functional/hash.hpp"
+#include "iterator/iterator.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace anya {
+
+// 以字符串为key的哈希映射，key的字符直接放在结点末尾
+// unordered_map<std::string, T> 的结点里是一个 std::string，超过15字节的key还要再分配一次，比较时还要再跳一次指针；
+// 这里每个元素只有一次分配：结点头是链指针、key的长度和哈希值的高32位，之后是值，最后是key的字符
+// 查找时先比较长度和哈希值的高32位，都相同时才用一次 memcmp 比较key，不会访问结点以外的内存
+// key以 std::string_view 的形式给出和返回，迭代器解引用得到 pair<std::string_view, T&>
+template<
+    class T,
+    class Hash         = anya::string_hash,
+    class RehashPolicy = anya::default_rehash_policy>
+class string_unordered_map {
+private:
+    struct string_node {
+        string_node* next;
+        uint32_t     length;   // key的长度
+        uint32_t     tag;      // 哈希值的高32位
+        T            value;
+
+        [[nodiscard]] char*
+        key_data() noexcept { return reinterpret_cast<char*>(this + 1); }
+
+        [[nodiscard]] std::string_view
+        key() const noexcept { return {reinterpret_cast<const char*>(this + 1), length}; }
+    };
+
+    // 内存池按8字节对齐分配
+    static_assert(alignof(T) <= alignof(void*), "string_unordered_map does not support over-aligned values");
+
+public:
+    using key_type        = std::string_view;
+    using mapped_type     = T;
+    using value_type      = std::pair<std::string_view, T>;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using rehash_policy   = RehashPolicy;
+
+private:
+    template<bool Const>
+    class string_map_iterator
+        : public anya::iterator<anya::forward_iterator_tag, value_type> {
+    private:
+        friend class string_unordered_map;
+
+        using table_pointer = std::conditional_t<Const, const string_unordered_map*, string_unordered_map*>;
+
+        string_node*  current;   // 迭代器当前位置
+        size_t        bucket;    // 当前结点所在的桶
+        table_pointer table;     // 所属的容器
+
+    public:
+        using reference = std::pair<std::string_view, std::conditional_t<Const, const T&, T&>>;
+
+        // operator-> 返回的临时对象
+        struct pointer {
+            reference ref;
+
+            reference*
+            operator->() noexcept { return std::addressof(ref); }
+        };
+
+    public:
+        string_map_iterator() = default;
+
+        string_map_iterator(string_node* node, size_t index, table_pointer belong)
+            : current(node), bucket(index), table(belong) {}
+
+        template<bool OtherConst>
+        requires (Const && !OtherConst)
+        string_map_iterator(const string_map_iterator<OtherConst>& other) noexcept
+            : current(other.current), bucket(other.bucket), table(other.table) {}
+
+    public:
+        reference
+        operator*() const { return {current->key(), current->value}; }
+
+        pointer
+        operator->() const { return {**this}; }
+
+        [[nodiscard]] std::string_view
+        key() const noexcept { return current->key(); }
+
+        std::conditional_t<Const, const T&, T&>
+        value() const noexcept { return current->value; }
+
+        string_map_iterator&
+        operator++() {
+            table->next_node(current, bucket); return *this;
+        }
+
+        string_map_iterator
+        operator++(int) {
+            string_map_iterator tmp = *this; return ++*this, tmp;
+        }
+
+        friend bool
+        operator==(const string_map_iterator& lhs, const string_map_iterator& rhs) {
+            return lhs.current == rhs.current;
+        }
+
+        friend bool
+        operator!=(const string_map_iterator& lhs, const string_map_iterator& rhs) {
+            return !(lhs == rhs);
+        }
+    };
+
+public:
+    using iterator       = string_map_iterator<false>;
+    using const_iterator = string_map_iterator<true>;
+
+private:
+    using bucket_container = anya::vector<string_node*>;
+
+    anya::allocator<char> node_alloc{};   // 结点与key一起分配，大小随key的长度变化
+    hasher                hash_fcn{};     // 哈希函数
+    bucket_container      buckets{};      // 桶数组
+    size_t                elements{};     // 元素数量
+    size_t                first{};        // 第一个非空桶的下标，表为空时等于桶的个数
+    float                 factor = 1;     // 装载因子上限
+
+    // 默认桶的个数，实际个数由 RehashPolicy 取整
+    constexpr static size_t default_size = 11;
+
+#pragma region 构造 && 析构
+public:
+    string_unordered_map() : string_unordered_map(default_size) {}
+
+    explicit
+    string_unordered_map(size_t bucket_count, const hasher& hash = hasher())
+        : hash_fcn(hash), buckets(RehashPolicy::next_bucket_count(bucket_count), nullptr), first(buckets.size()) {}
+
+    string_unordered_map(std::initializer_list<std::pair<std::string_view, T>> init)
+        : string_unordered_map(init.size()) {
+        for (auto& [key, value] : init) try_emplace(key, value);
+    }
+
+    string_unordered_map(const string_unordered_map& other)
+        : hash_fcn(other.hash_fcn), buckets(other.buckets.size(), nullptr),
+          first(other.buckets.size()), factor(other.factor) {
+        try {
+            copy_nodes(other);
+        }
+        catch (...) {
+            destroy_all();
+            throw;
+        }
+    }
+
+    string_unordered_map(string_unordered_map&& other) noexcept
+        : hash_fcn(std::move(other.hash_fcn)), buckets(std::move(other.buckets)),
+          elements(std::exchange(other.elements, 0)), first(std::exchange(other.first, 0)), factor(other.factor) {}
+
+    ~string_unordered_map() { destroy_all(); }
+#pragma endregion
+
+
+#pragma region 赋值
+public:
+    string_unordered_map&
+    operator=(const string_unordered_map& other) {
+        if (this != &other) {
+            string_unordered_map temp(other);
+            swap(temp);
+        }
+        return *this;
+    }
+
+    string_unordered_map&
+    operator=(string_unordered_map&& other) noexcept {
+        if (this != &other) {
+            destroy_all();
+            hash_fcn = std::move(other.hash_fcn);
+            buckets  = std::move(other.buckets);
+            elements = std::exchange(other.elements, 0);
+            first    = std::exchange(other.first, 0);
+            factor   = other.factor;
+        }
+        return *this;
+    }
+#pragma endregion
+
+
+#pragma region 迭代器
+public:
+    iterator
+    begin() noexcept { return iterator(first_bucket(), first, this); }
+
+    const_iterator
+    begin() const noexcept { return const_iterator(first_bucket(), first, this); }
+
+    const_iterator
+    cbegin() const noexcept { return begin(); }
+
+    iterator
+    end() noexcept { return iterator(nullptr, buckets.size(), this); }
+
+    const_iterator
+    end() const noexcept { return const_iterator(nullptr, buckets.size(), this); }
+
+    const_iterator
+    cend() const noexcept { return end(); }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] bool
+    empty() const noexcept { return elements == 0; }
+
+    [[nodiscard]] size_type
+    size() const noexcept { return elements; }
+
+    // 一个元素实际占用的内存：结点头、值和key的字符，按8字节取整
+    [[nodiscard]] constexpr static size_t
+    node_size(size_t key_length) noexcept { return (sizeof(string_node) + key_length + 7) & ~size_t(7); }
+
+    // 桶数组与所有结点占用的内存
+    [[nodiscard]] size_t
+    memory_usage() const noexcept {
+        size_t bytes = buckets.size() * sizeof(string_node*);
+        for (string_node* bucket : buckets) {
+            for (string_node* ptr = bucket; ptr; ptr = ptr->next) bytes += node_size(ptr->length);
+        }
+        return bytes;
+    }
+#pragma endregion
+
+
+#pragma region 修改器
+public:
+    void
+    clear() noexcept {
+        destroy_all();
+        first = buckets.size();
+    }
+
+    // key不存在时用 args 构造值并插入，存在时什么也不做
+    template<class... Args>
+    std::pair<iterator, bool>
+    try_emplace(std::string_view key, Args&&... args) {
+        size_t code = hash_fcn(key), pos = bucket_of(code);
+        if (string_node* exist = find_node(key, code, pos)) return {iterator(exist, pos, this), false};
+        string_node* node = make_node(key, code, std::forward<Args>(args)...);
+        if (is_overload(elements + 1, buckets.size())) {
+            try {
+                rebuild(RehashPolicy::next_bucket_count(std::ceil(static_cast<float>(elements + 1) / factor)));
+            }
+            catch (...) {
+                free_node(node);
+                throw;
+            }
+            pos = RehashPolicy::index(code, buckets.size());
+        }
+        node->next = buckets[pos], buckets[pos] = node;
+        first = anya::min(first, pos);
+        ++elements;
+        return {iterator(node, pos, this), true};
+    }
+
+    std::pair<iterator, bool>
+    insert(const std::pair<std::string_view, T>& value) { return try_emplace(value.first, value.second); }
+
+    template<class M>
+    std::pair<iterator, bool>
+    insert_or_assign(std::string_view key, M&& obj) {
+        auto result = try_emplace(key, std::forward<M>(obj));
+        if (!result.second) result.first.value() = std::forward<M>(obj);
+        return result;
+    }
+
+    iterator
+    erase(const_iterator pos) {
+        string_node* node = pos.current;
+        size_t index = pos.bucket;
+        iterator next(node, index, this);
+        ++next;
+        string_node** link = &buckets[index];
+        while (*link != node) link = &(*link)->next;
+        *link = node->next;
+        free_node(node);
+        --elements;
+        if (index == first && buckets[index] == nullptr) first = next.bucket;
+        return next;
+    }
+
+    iterator
+    erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    size_type
+    erase(std::string_view key) {
+        auto it = find(key);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+
+    void
+    swap(string_unordered_map& other) noexcept {
+        std::swap(hash_fcn, other.hash_fcn);
+        buckets.swap(other.buckets);
+        std::swap(elements, other.elements);
+        std::swap(first, other.first);
+        std::swap(factor, other.factor);
+    }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    T&
+    at(std::string_view key) {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("string_unordered_map has not this key");
+        return it.value();
+    }
+
+    const T&
+    at(std::string_view key) const {
+        auto it = find(key);
+        if (it == end()) throw std::out_of_range("string_unordered_map has not this key");
+        return it.value();
+    }
+
+    T&
+    operator[](std::string_view key) { return try_emplace(key).first.value(); }
+
+    iterator
+    find(std::string_view key) {
+        size_t code = hash_fcn(key), pos = bucket_of(code);
+        string_node* node = find_node(key, code, pos);
+        return node ? iterator(node, pos, this) : end();
+    }
+
+    const_iterator
+    find(std::string_view key) const {
+        size_t code = hash_fcn(key), pos = bucket_of(code);
+        string_node* node = find_node(key, code, pos);
+        return node ? const_iterator(node, pos, this) : end();
+    }
+
+    [[nodiscard]] bool
+    contains(std::string_view key) const { return find(key) != end(); }
+
+    [[nodiscard]] size_type
+    count(std::string_view key) const { return contains(key); }
+#pragma endregion
+
+
+#pragma region 哈希策略
+public:
+    [[nodiscard]] size_type
+    bucket_count() const noexcept { return buckets.size(); }
+
+    [[nodiscard]] float
+    load_factor() const noexcept { return static_cast<float>(elements) / static_cast<float>(buckets.size()); }
+
+    [[nodiscard]] float
+    max_load_factor() const noexcept { return factor; }
+
+    void
+    max_load_factor(float ml) {
+        if (ml <= 0 || std::isnan(ml)) throw std::invalid_argument("max_load_factor must be positive");
+        factor = ml;
+        if (is_overload(elements, buckets.size())) rehash(0);
+    }
+
+    // 桶数至少为count且能容纳现有元素，可能缩小
+    void
+    rehash(size_type count) {
+        size_t needed = std::ceil(static_cast<float>(elements) / factor);
+        size_t new_bucket_size = RehashPolicy::next_bucket_count(anya::max(count, needed));
+        if (new_bucket_size != buckets.size()) rebuild(new_bucket_size);
+    }
+
+    void
+    reserve(size_type count) {
+        if (is_overload(count, buckets.size())) rehash(std::ceil(static_cast<float>(count) / factor));
+    }
+#pragma endregion
+
+
+#pragma region 观察器
+public:
+    hasher
+    hash_function() const { return hash_fcn; }
+#pragma endregion
+
+
+#pragma region 工具函数
+private:
+    // 哈希值的高32位，与长度一起先于key比较，不同的key几乎不会走到 memcmp
+    constexpr static uint32_t
+    hash_tag(size_t code) noexcept { return static_cast<uint32_t>(static_cast<uint64_t>(code) >> 32); }
+
+    // 被移动后的表没有桶数组，此时返回0，由 find_node 直接判定为不存在
+    size_t
+    bucket_of(size_t code) const noexcept { return buckets.empty() ? 0 : RehashPolicy::index(code, buckets.size()); }
+
+    string_node*
+    find_node(std::string_view key, size_t code, size_t pos) const {
+        if (buckets.empty()) return nullptr;
+        uint32_t tag = hash_tag(code);
+        for (string_node* ptr = buckets[pos]; ptr; ptr = ptr->next) {
+            if (ptr->tag == tag && ptr->length == key.size() && std::memcmp(ptr->key_data(), key.data(), key.size()) == 0) {
+                return ptr;
+            }
+        }
+        return nullptr;
+    }
+
+    template<class... Args>
+    string_node*
+    make_node(std::string_view key, size_t code, Args&&... args) {
+        if (key.size() > UINT32_MAX) throw std::length_error("string_unordered_map key is too long");
+        auto node = reinterpret_cast<string_node*>(node_alloc.allocate(node_size(key.size())));
+        try {
+            node_alloc.construct(std::addressof(node->value), std::forward<Args>(args)...);
+        }
+        catch (...) {
+            node_alloc.deallocate(reinterpret_cast<char*>(node), node_size(key.size()));
+            throw;
+        }
+        node->next   = nullptr;
+        node->length = static_cast<uint32_t>(key.size());
+        node->tag    = hash_tag(code);
+        if (!key.empty()) std::memcpy(node->key_data(), key.data(), key.size());
+        return node;
+    }
+
+    void
+    free_node(string_node* node) noexcept {
+        anya::destroy_at(std::addressof(node->value));
+        node_alloc.deallocate(reinterpret_cast<char*>(node), node_size(node->length));
+    }
+
+    void
+    destroy_all() noexcept {
+        for (string_node*& bucket : buckets) {
+            while (bucket) {
+                string_node* next = bucket->next;
+                free_node(bucket);
+                bucket = next;
+            }
+        }
+        elements = 0;
+    }
+
+    // 桶数相同，逐个桶按原来的顺序复制
+    void
+    copy_nodes(const string_unordered_map& other) {
+        for (size_t i = 0; i < other.buckets.size(); ++i) {
+            string_node** tail = &buckets[i];
+            for (string_node* ptr = other.buckets[i]; ptr; ptr = ptr->next) {
+                string_node* node = make_node(ptr->key(), 0, ptr->value);
+                node->tag = ptr->tag;
+                *tail = node, tail = &node->next;
+                ++elements;
+            }
+        }
+        first = other.first;
+    }
+
+    // 把所有结点重新分配到 new_bucket_size 个桶中；结点里没有完整的哈希值，需要重新计算
+    void
+    rebuild(size_t new_bucket_size) {
+        bucket_container temp(new_bucket_size, nullptr);
+        first = new_bucket_size;
+        for (string_node* ptr : buckets) {
+            while (ptr) {
+                string_node* next = ptr->next;
+                size_t pos = RehashPolicy::index(hash_fcn(ptr->key()), new_bucket_size);
+                ptr->next = temp[pos], temp[pos] = ptr;
+                first = anya::min(first, pos);
+                ptr = next;
+            }
+        }
+        buckets.swap(temp);
+    }
+
+    [[nodiscard]] bool
+    is_overload(size_t element_size, size_t bucket_size) const {
+        return static_cast<float>(element_size) > static_cast<float>(bucket_size) * factor;
+    }
+
+    string_node*
+    first_bucket() const noexcept { return first < buckets.size() ? buckets[first] : nullptr; }
+
+    // cur 移到下一个结点，当前链走完时找下一个非空桶
+    void
+    next_node(string_node*& cur, size_t& index) const {
+        if (cur && (cur = cur->next)) return;
+        while (++index < buckets.size()) {
+            if ((cur = buckets[index])) return;
+        }
+        index = buckets.size();
+    }
+#pragma endregion
+
+
+#pragma region 友元比较函数
+public:
+    friend bool
+    operator==(const string_unordered_map& lhs, const string_unordered_map& rhs) {
+        if (lhs.size() != rhs.size()) return false;
+        for (auto it = lhs.begin(); it != lhs.end(); ++it) {
+            auto other = rhs.find(it.key());
+            if (other == rhs.end() || !(other.value() == it.value())) return false;
+        }
+        return true;
+    }
+#pragma endregion
+};
+
+template<class T, class Hash, class RehashPolicy>
+void
+swap(anya::string_unordered_map<T, Hash, RehashPolicy>& lhs,
+     anya::string_unordered_map<T, Hash, RehashPolicy>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+}
+
+#endif //ANYA_STL_STRING_UNORDERED_MAP_HPP
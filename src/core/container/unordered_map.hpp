@@ -6,18 +6,20 @@
 #define ANYA_STL_UNORDERED_MAP_HPP
 
 #include "container/built-in/hashtable.hpp"
+#include "container/frozen_unordered_map.hpp"
 
 namespace anya {
 
 template<
     class Key,
     class T,
-    class Hash      = std::hash<Key>,
+    class Hash      = anya::hash<Key>,
     class KeyEqual  = std::equal_to<Key>,
-    class Allocator = anya::allocator<std::pair<const Key, T>>>
+    class Allocator = anya::allocator<std::pair<const Key, T>>,
+    class RehashPolicy = anya::default_rehash_policy>
 class unordered_map {
 private:
-    using base_map = hashtable<Key, T, Hash, KeyEqual, Allocator>;
+    using base_map = hashtable<Key, T, Hash, KeyEqual, Allocator, RehashPolicy>;
 
 public:
     using key_type        = Key;
@@ -27,6 +29,7 @@ public:
     using difference_type = ptrdiff_t;
     using hasher          = Hash;
     using key_equal       = KeyEqual;
+    using rehash_policy   = RehashPolicy;
     using allocator_type  = anya::allocator<std::pair<const Key, T>>;
     using reference       = value_type&;
     using const_reference = const value_type&;
@@ -34,6 +37,11 @@ public:
     using const_pointer   = const value_type*;
     using iterator        = typename base_map::iterator;
     using const_iterator  = typename base_map::const_iterator;
+    using node_type       = typename base_map::node_type;
+    using insert_return_type = typename base_map::insert_return_type;
+
+    // 哈希函数与比较函数是否都是透明的
+    constexpr static bool is_transparent = base_map::is_transparent;
 
 private:
     base_map table;
@@ -108,6 +116,13 @@ public:
 
     const_iterator
     cend() const noexcept { return table.cend(); }
+
+    // 把元素切成至多 parts 段首尾相接的迭代器对，可以交给不同的线程同时遍历，见 anya::parallel_for_each
+    anya::vector<std::pair<iterator, iterator>>
+    split(size_t parts) { return table.split(parts); }
+
+    anya::vector<std::pair<const_iterator, const_iterator>>
+    split(size_t parts) const { return table.split(parts); }
 #pragma endregion
 
 
@@ -148,12 +163,49 @@ public:
         while (first != last) emplace(*first++);
     }
 
+    // 批量插入，先一次性扩容再分组预取，返回实际插入的个数
+    template<class ForwardIt>
+    size_type
+    insert_batch(ForwardIt first, ForwardIt last) { return table.insert_batch(first, last); }
+
+    // 在线程池 pool 上多线程批量插入，threads 为0时取 pool 的大小，元素较少时退化为逐个插入；重复的key保留先出现的，返回实际插入的个数
+    // 元素的构造、哈希与比较会在多个线程中同时调用
+    template<class RandomIt>
+    size_type
+    insert_parallel(RandomIt first, RandomIt last, size_t threads = 0, thread_pool& pool = default_thread_pool()) {
+        return table.insert_parallel_unique(first, last, threads, pool);
+    }
+
     template<class... Args>
     std::pair<iterator, bool>
     emplace(Args&&... args) {
         return table.template emplace_unique(std::forward<Args>(args)...);
     }
 
+    template<class... Args>
+    std::pair<iterator, bool>
+    try_emplace(const Key& key, Args&&... args) {
+        return table.try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool>
+    try_emplace(Key&& key, Args&&... args) {
+        return table.try_emplace(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template<class M>
+    std::pair<iterator, bool>
+    insert_or_assign(const Key& key, M&& obj) {
+        return table.insert_or_assign(key, std::forward<M>(obj));
+    }
+
+    template<class M>
+    std::pair<iterator, bool>
+    insert_or_assign(Key&& key, M&& obj) {
+        return table.insert_or_assign(std::move(key), std::forward<M>(obj));
+    }
+
     iterator
     erase(const_iterator pos) { return table.erase(pos); }
 
@@ -163,8 +215,43 @@ public:
     size_type
     erase(const Key& key) { return table.erase(key); }
 
+    template<class K>
+    requires base_map::template transparent_key<K>
+    size_type
+    erase(K&& key) { return table.erase(std::forward<K>(key)); }
+
+    // 删除所有满足 pred 的元素，返回删除的个数
+    template<class UnaryPredicate>
+    size_type
+    erase_if(UnaryPredicate pred) { return table.erase_if(pred); }
+
     void
     swap(unordered_map &other) noexcept { table.swap(other.table); }
+
+    // 结点句柄：摘下和重新插入结点都不会分配或释放内存
+    node_type
+    extract(const_iterator pos) { return table.extract(pos); }
+
+    node_type
+    extract(const Key& key) { return table.extract(key); }
+
+    template<class K>
+    requires base_map::template transparent_key<K>
+    node_type
+    extract(K&& key) { return table.extract(std::forward<K>(key)); }
+
+    insert_return_type
+    insert(node_type&& node) { return table.insert_unique(std::move(node)); }
+
+    iterator
+    insert(const_iterator, node_type&& node) { return table.insert_unique(std::move(node)).position; }
+
+    // 把source中key不存在于本容器的元素移动过来，其余元素留在source中
+    void
+    merge(unordered_map& source) { table.merge_unique(source.table); }
+
+    void
+    merge(unordered_map&& source) { table.merge_unique(source.table); }
 #pragma endregion
 
 
@@ -186,35 +273,98 @@ public:
         return it->second;
     }
 
+    template<class K>
+    requires base_map::template transparent_key<K>
+    T&
+    at(const K& key) {
+        auto it = table.find(key);
+        if (it == table.end())
+            throw std::out_of_range("unordered_map has not this key");
+        return it->second;
+    }
+
+    template<class K>
+    requires base_map::template transparent_key<K>
+    const T&
+    at(const K& key) const {
+        auto it = table.find(key);
+        if (it == table.end())
+            throw std::out_of_range("unordered_map has not this key");
+        return it->second;
+    }
+
     T&
     operator[](const Key& key) {
-        auto ret = table.emplace_unique(key, T{});
-        return ret.first->second;
+        return table.try_emplace(key).first->second;
     }
 
     T&
     operator[](Key&& key) {
-        auto ret = table.emplace_unique(std::move(key), T{});
-        return ret.first->second;
+        return table.try_emplace(std::move(key)).first->second;
     }
 
     size_type
     count(const Key& key) const { return table.count(key); }
 
+    template<class K>
+    requires base_map::template transparent_key<K>
+    size_type
+    count(const K& key) const { return table.count(key); }
+
     iterator
     find(const Key& key) { return table.find(key); }
 
     const_iterator
     find(const Key& key) const { return table.find(key); }
 
+    template<class K>
+    requires base_map::template transparent_key<K>
+    iterator
+    find(const K& key) { return table.find(key); }
+
+    template<class K>
+    requires base_map::template transparent_key<K>
+    const_iterator
+    find(const K& key) const { return table.find(key); }
+
     bool
     contains(const Key& key) const { return find(key) != end(); }
 
+    template<class K>
+    requires base_map::template transparent_key<K>
+    bool
+    contains(const K& key) const { return find(key) != end(); }
+
     std::pair<iterator, iterator>
     equal_range(const Key& key) { return table.equal_range(key); }
 
     std::pair<const_iterator, const_iterator>
     equal_range(const Key& key) const { return table.equal_range(key); }
+
+    template<class K>
+    requires base_map::template transparent_key<K>
+    std::pair<iterator, iterator>
+    equal_range(const K& key) { return table.equal_range(key); }
+
+    template<class K>
+    requires base_map::template transparent_key<K>
+    std::pair<const_iterator, const_iterator>
+    equal_range(const K& key) const { return table.equal_range(key); }
+
+    // 批量查找，依次把每个key的查找结果写入result
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    find_batch(ForwardIt first, ForwardIt last, OutputIt result) { return table.find_batch(first, last, result); }
+
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    find_batch(ForwardIt first, ForwardIt last, OutputIt result) const { return table.find_batch(first, last, result); }
+
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    contains_batch(ForwardIt first, ForwardIt last, OutputIt result) const {
+        return table.contains_batch(first, last, result);
+    }
 #pragma endregion
 
 
@@ -236,17 +386,71 @@ public:
 
 #pragma region 哈希策略
 public:
+    [[nodiscard]] float
+    load_factor() const { return table.load_factor(); }
+
     [[nodiscard]] float
     max_load_factor() const { return table.max_load_factor(); }
 
     void
     max_load_factor(float ml) { table.max_load_factor(ml); }
 
+    // 装载因子下限，按key删除后低于它时，在下一次插入时缩小桶数组，为0时关闭
+    [[nodiscard]] float
+    min_load_factor() const { return table.min_load_factor(); }
+
+    void
+    min_load_factor(float ml) { table.min_load_factor(ml); }
+
     void
     rehash(size_type count) { table.rehash(count); }
 
     void
     reserve(size_type count) { table.reserve(count); }
+
+    // 渐进式rehash每次插入迁移的桶数，为0时关闭（默认），扩容时一次性迁移所有结点
+    void
+    incremental_rehash(size_t step) { table.incremental_rehash(step); }
+
+    [[nodiscard]] size_t
+    incremental_rehash() const noexcept { return table.incremental_rehash(); }
+
+    // 是否正在进行渐进式rehash
+    [[nodiscard]] bool
+    rehashing() const noexcept { return table.rehashing(); }
+
+    // 在线程池 pool 上用 threads 个线程重新分配结点，threads 为0时取 pool 的大小
+    void
+    rehash(size_type count, size_t threads, thread_pool& pool = default_thread_pool()) { table.rehash(count, threads, pool); }
+
+    void
+    reserve(size_type count, size_t threads, thread_pool& pool = default_thread_pool()) { table.reserve(count, threads, pool); }
+
+    void
+    shrink_to_fit() { table.shrink_to_fit(); }
+#pragma endregion
+
+
+#pragma region 统计
+public:
+    // 链长分布、最长链、空桶比例和实际装载因子
+    [[nodiscard]] hashtable_statistics
+    statistics(size_type max_chain = 16) const { return table.statistics(max_chain); }
+
+    // 查找、探测、rehash 的计数，需要为 Hash 打开 hash_stats_enabled
+    [[nodiscard]] hashtable_counters
+    counters() const noexcept { return table.counters(); }
+
+    void
+    reset_counters() noexcept { table.reset_counters(); }
+#pragma endregion
+
+
+#pragma region 冻结
+public:
+    // 复制成只读的最小完美哈希表，装载完成后不再修改的表用它查找更快、更省内存
+    [[nodiscard]] frozen_unordered_map<Key, T, Hash, KeyEqual, Allocator>
+    freeze() const { return {begin(), end(), hash_function(), key_eq()}; }
 #pragma endregion
 
 
@@ -278,15 +482,23 @@ public:
 template<
     class Key,
     class T,
-    class Hash      = std::hash<Key>,
+    class Hash      = anya::hash<Key>,
     class KeyEqual  = std::equal_to<Key>,
-    class Allocator = anya::allocator<std::pair<const Key, T>>>
+    class Allocator = anya::allocator<std::pair<const Key, T>>,
+    class RehashPolicy = anya::default_rehash_policy>
 constexpr void
-swap(anya::unordered_map<Key, T, Hash, KeyEqual, Allocator>& lhs,
-     anya::unordered_map<Key, T, Hash, KeyEqual, Allocator>& rhs) noexcept {
+swap(anya::unordered_map<Key, T, Hash, KeyEqual, Allocator, RehashPolicy>& lhs,
+     anya::unordered_map<Key, T, Hash, KeyEqual, Allocator, RehashPolicy>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
+// 删除所有满足 pred 的元素，返回删除的个数
+template<class Key, class T, class Hash, class KeyEqual, class Allocator, class RehashPolicy, class UnaryPredicate>
+typename anya::unordered_map<Key, T, Hash, KeyEqual, Allocator, RehashPolicy>::size_type
+erase_if(anya::unordered_map<Key, T, Hash, KeyEqual, Allocator, RehashPolicy>& c, UnaryPredicate pred) {
+    return c.erase_if(pred);
+}
+
 
 }
 
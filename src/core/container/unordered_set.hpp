@@ -0,0 +1,403 @@
+//
+// Created by Anya on 2023/8/15.
+//
+
+#ifndef ANYA_STL_UNORDERED_SET_HPP
+#define ANYA_STL_UNORDERED_SET_HPP
+
+#include "container/built-in/hashtable.hpp"
+
+namespace anya {
+
+template<
+    class Key,
+    class Hash      = anya::hash<Key>,
+    class KeyEqual  = std::equal_to<Key>,
+    class Allocator = anya::allocator<Key>,
+    class RehashPolicy = anya::default_rehash_policy>
+class unordered_set {
+private:
+    // 结点只存放key，T只是占位
+    using base_set = hashtable<Key, Key, Hash, KeyEqual, Allocator, RehashPolicy, anya::set_key_policy<Key>>;
+
+public:
+    using key_type        = Key;
+    using value_type      = Key;
+    using size_type       = size_t;
+    using difference_type = ptrdiff_t;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using rehash_policy   = RehashPolicy;
+    using allocator_type  = anya::allocator<Key>;
+    using reference       = value_type&;
+    using const_reference = const value_type&;
+    using pointer         = value_type*;
+    using const_pointer   = const value_type*;
+    // 集合的元素就是key，不允许通过迭代器修改
+    using iterator        = typename base_set::const_iterator;
+    using const_iterator  = typename base_set::const_iterator;
+    using node_type       = typename base_set::node_type;
+
+    struct insert_return_type {
+        iterator  position;
+        bool      inserted;
+        node_type node;
+    };
+
+    // 哈希函数与比较函数是否都是透明的
+    constexpr static bool is_transparent = base_set::is_transparent;
+
+private:
+    base_set table;
+    constexpr static size_t default_size = 11;
+
+#pragma region 构造 && 析构
+public:
+    unordered_set() = default;
+
+    explicit unordered_set(size_type bucket_count,
+                           const hasher& hash = hasher(),
+                           const key_equal& equal = key_equal())
+        : table(bucket_count, hash, equal)
+    {}
+
+    template<class InputIt>
+    requires std::derived_from<typename InputIt::iterator_category, anya::input_iterator_tag>
+    unordered_set(InputIt first, InputIt last,
+                  size_type bucket_count = default_size,
+                  const hasher& hash = hasher(),
+                  const key_equal& equal = key_equal())
+        : table(bucket_count, hash, equal) {
+        while (first != last) emplace(*first++);
+    }
+
+    unordered_set(const unordered_set&) = default;
+
+    unordered_set(unordered_set&&) noexcept = default;
+
+    unordered_set(std::initializer_list<value_type> init,
+                  size_type bucket_count = default_size,
+                  const hasher& hash = hasher(),
+                  const key_equal& equal = key_equal())
+        : table(bucket_count, hash, equal) {
+        auto first = init.begin(), last = init.end();
+        while (first != last) emplace(*first++);
+    }
+
+    ~unordered_set() = default;
+#pragma endregion
+
+
+#pragma region 赋值
+public:
+    unordered_set&
+    operator=(const unordered_set&) = default;
+
+    unordered_set&
+    operator=(unordered_set&&) noexcept = default;
+
+    allocator_type
+    get_allocator() const noexcept { return table.get_allocator(); }
+#pragma endregion
+
+
+#pragma region 迭代器
+public:
+    iterator
+    begin() const noexcept { return table.begin(); }
+
+    const_iterator
+    cbegin() const noexcept { return table.cbegin(); }
+
+    iterator
+    end() const noexcept { return table.end(); }
+
+    const_iterator
+    cend() const noexcept { return table.cend(); }
+
+    // 把元素切成至多 parts 段首尾相接的迭代器对，可以交给不同的线程同时遍历，见 anya::parallel_for_each
+    anya::vector<std::pair<const_iterator, const_iterator>>
+    split(size_t parts) const { return table.split(parts); }
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    [[nodiscard]] bool
+    empty() const noexcept { return table.empty(); }
+
+    [[nodiscard]] size_type
+    size() const noexcept { return table.size(); }
+
+    [[nodiscard]] size_type
+    max_size() const noexcept { return table.max_size(); }
+#pragma endregion
+
+
+#pragma region 修改器
+public:
+    void
+    clear() noexcept { return table.clear(); }
+
+    std::pair<iterator, bool>
+    insert(const value_type& value) { return emplace(value); }
+
+    std::pair<iterator, bool>
+    insert(value_type&& value) { return emplace(std::move(value)); }
+
+    template<class InputIt>
+    requires std::derived_from<typename InputIt::iterator_category, anya::input_iterator_tag>
+    void
+    insert(InputIt first, InputIt last) {
+        while (first != last) emplace(*first++);
+    }
+
+    void
+    insert(std::initializer_list<value_type> ilist) {
+        auto first = ilist.begin(), last = ilist.end();
+        while (first != last) emplace(*first++);
+    }
+
+    // 批量插入，先一次性扩容再分组预取，返回实际插入的个数
+    template<class ForwardIt>
+    size_type
+    insert_batch(ForwardIt first, ForwardIt last) { return table.insert_batch(first, last); }
+
+    // 在线程池 pool 上多线程批量插入，threads 为0时取 pool 的大小，元素较少时退化为逐个插入；重复的key保留先出现的，返回实际插入的个数
+    // 元素的构造、哈希与比较会在多个线程中同时调用
+    template<class RandomIt>
+    size_type
+    insert_parallel(RandomIt first, RandomIt last, size_t threads = 0, thread_pool& pool = default_thread_pool()) {
+        return table.insert_parallel_unique(first, last, threads, pool);
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool>
+    emplace(Args&&... args) {
+        return table.template emplace_unique(std::forward<Args>(args)...);
+    }
+
+    iterator
+    erase(const_iterator pos) { return table.erase(pos); }
+
+    iterator
+    erase(const_iterator first, const_iterator last) { return table.erase(first, last); }
+
+    size_type
+    erase(const Key& key) { return table.erase(key); }
+
+    template<class K>
+    requires base_set::template transparent_key<K>
+    size_type
+    erase(K&& key) { return table.erase(std::forward<K>(key)); }
+
+    // 删除所有满足 pred 的元素，返回删除的个数
+    template<class UnaryPredicate>
+    size_type
+    erase_if(UnaryPredicate pred) { return table.erase_if(pred); }
+
+    void
+    swap(unordered_set& other) noexcept { table.swap(other.table); }
+
+    // 结点句柄：摘下和重新插入结点都不会分配或释放内存
+    node_type
+    extract(const_iterator pos) { return table.extract(pos); }
+
+    node_type
+    extract(const Key& key) { return table.extract(key); }
+
+    template<class K>
+    requires base_set::template transparent_key<K>
+    node_type
+    extract(K&& key) { return table.extract(std::forward<K>(key)); }
+
+    insert_return_type
+    insert(node_type&& node) {
+        auto result = table.insert_unique(std::move(node));
+        return {result.position, result.inserted, std::move(result.node)};
+    }
+
+    iterator
+    insert(const_iterator, node_type&& node) { return table.insert_unique(std::move(node)).position; }
+
+    // 把source中本容器没有的元素移动过来，其余元素留在source中
+    void
+    merge(unordered_set& source) { table.merge_unique(source.table); }
+
+    void
+    merge(unordered_set&& source) { table.merge_unique(source.table); }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    size_type
+    count(const Key& key) const { return table.count(key); }
+
+    template<class K>
+    requires base_set::template transparent_key<K>
+    size_type
+    count(const K& key) const { return table.count(key); }
+
+    iterator
+    find(const Key& key) const { return table.find(key); }
+
+    template<class K>
+    requires base_set::template transparent_key<K>
+    iterator
+    find(const K& key) const { return table.find(key); }
+
+    bool
+    contains(const Key& key) const { return find(key) != end(); }
+
+    template<class K>
+    requires base_set::template transparent_key<K>
+    bool
+    contains(const K& key) const { return find(key) != end(); }
+
+    std::pair<iterator, iterator>
+    equal_range(const Key& key) const { return table.equal_range(key); }
+
+    template<class K>
+    requires base_set::template transparent_key<K>
+    std::pair<iterator, iterator>
+    equal_range(const K& key) const { return table.equal_range(key); }
+
+    // 批量查找，依次把每个key的查找结果写入result
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    find_batch(ForwardIt first, ForwardIt last, OutputIt result) const { return table.find_batch(first, last, result); }
+
+    template<class ForwardIt, class OutputIt>
+    OutputIt
+    contains_batch(ForwardIt first, ForwardIt last, OutputIt result) const {
+        return table.contains_batch(first, last, result);
+    }
+#pragma endregion
+
+
+#pragma region 桶接口
+public:
+    [[nodiscard]] size_type
+    bucket_count() const { return table.bucket_count(); }
+
+    [[nodiscard]] size_type
+    max_bucket_count() const { return table.max_bucket_count(); }
+
+    [[nodiscard]] size_type
+    bucket_size(size_type n) const { return table.bucket_size(n); }
+
+    [[nodiscard]] size_type
+    bucket(const Key& key) const { return table.bucket(key); }
+#pragma endregion
+
+
+#pragma region 哈希策略
+public:
+    [[nodiscard]] float
+    load_factor() const { return table.load_factor(); }
+
+    [[nodiscard]] float
+    max_load_factor() const { return table.max_load_factor(); }
+
+    void
+    max_load_factor(float ml) { table.max_load_factor(ml); }
+
+    // 装载因子下限，按key删除后低于它时，在下一次插入时缩小桶数组，为0时关闭
+    [[nodiscard]] float
+    min_load_factor() const { return table.min_load_factor(); }
+
+    void
+    min_load_factor(float ml) { table.min_load_factor(ml); }
+
+    void
+    rehash(size_type count) { table.rehash(count); }
+
+    void
+    reserve(size_type count) { table.reserve(count); }
+
+    // 渐进式rehash每次插入迁移的桶数，为0时关闭（默认），扩容时一次性迁移所有结点
+    void
+    incremental_rehash(size_t step) { table.incremental_rehash(step); }
+
+    [[nodiscard]] size_t
+    incremental_rehash() const noexcept { return table.incremental_rehash(); }
+
+    // 是否正在进行渐进式rehash
+    [[nodiscard]] bool
+    rehashing() const noexcept { return table.rehashing(); }
+
+    // 在线程池 pool 上用 threads 个线程重新分配结点，threads 为0时取 pool 的大小
+    void
+    rehash(size_type count, size_t threads, thread_pool& pool = default_thread_pool()) { table.rehash(count, threads, pool); }
+
+    void
+    reserve(size_type count, size_t threads, thread_pool& pool = default_thread_pool()) { table.reserve(count, threads, pool); }
+
+    void
+    shrink_to_fit() { table.shrink_to_fit(); }
+#pragma endregion
+
+
+#pragma region 统计
+public:
+    // 链长分布、最长链、空桶比例和实际装载因子
+    [[nodiscard]] hashtable_statistics
+    statistics(size_type max_chain = 16) const { return table.statistics(max_chain); }
+
+    // 查找、探测、rehash 的计数，需要为 Hash 打开 hash_stats_enabled
+    [[nodiscard]] hashtable_counters
+    counters() const noexcept { return table.counters(); }
+
+    void
+    reset_counters() noexcept { table.reset_counters(); }
+#pragma endregion
+
+
+#pragma region 观察器
+public:
+    hasher
+    hash_function() const { return table.hash_function(); }
+
+    key_equal
+    key_eq() const { return table.key_eq(); }
+#pragma endregion
+
+
+#pragma region 友元比较函数
+public:
+    friend bool
+    operator==(const unordered_set& lhs, const unordered_set& rhs) {
+        return lhs.table == rhs.table;
+    }
+
+    friend bool
+    operator!=(const unordered_set& lhs, const unordered_set& rhs) {
+        return !(rhs == lhs);
+    }
+#pragma endregion
+};
+
+// 特化 anya::swap 算法
+template<
+    class Key,
+    class Hash      = anya::hash<Key>,
+    class KeyEqual  = std::equal_to<Key>,
+    class Allocator = anya::allocator<Key>,
+    class RehashPolicy = anya::default_rehash_policy>
+constexpr void
+swap(anya::unordered_set<Key, Hash, KeyEqual, Allocator, RehashPolicy>& lhs,
+     anya::unordered_set<Key, Hash, KeyEqual, Allocator, RehashPolicy>& rhs) noexcept {
+    lhs.swap(rhs);
+}
+
+// 删除所有满足 pred 的元素，返回删除的个数
+template<class Key, class Hash, class KeyEqual, class Allocator, class RehashPolicy, class UnaryPredicate>
+typename anya::unordered_set<Key, Hash, KeyEqual, Allocator, RehashPolicy>::size_type
+erase_if(anya::unordered_set<Key, Hash, KeyEqual, Allocator, RehashPolicy>& c, UnaryPredicate pred) {
+    return c.erase_if(pred);
+}
+
+}
+
+#endif //ANYA_STL_UNORDERED_SET_HPP
@@ -29,7 +29,7 @@ public:
     using const_reference = const T&;
     using size_type       = size_t;
     using difference_type = ptrdiff_t;
-    using allocator_type  = anya::allocator<T>;
+    using allocator_type  = Allocator;
 
 public:
     using iterator               = anya::normal_iterator<pointer, vector>;
@@ -597,6 +597,16 @@ swap(anya::vector<T, Alloc>& lhs, anya::vector<T, Alloc>& rhs) noexcept {
     lhs.swap(rhs);
 }
 
+// 删除所有满足 pred 的元素，其余元素保持原来的顺序，返回删除的个数
+template<class T, class Alloc, class UnaryPredicate>
+constexpr typename anya::vector<T, Alloc>::size_type
+erase_if(anya::vector<T, Alloc>& c, UnaryPredicate pred) {
+    auto it = anya::remove_if(c.begin(), c.end(), pred);
+    auto removed = c.end() - it;
+    c.erase(it, c.end());
+    return removed;
+}
+
 }
 
 
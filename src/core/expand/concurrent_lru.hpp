@@ -0,0 +1,279 @@
+//
+// Created by Anya on 2023/8/29.
+//
+
+#ifndef ANYA_STL_CONCURRENT_LRU_HPP
+#define ANYA_STL_CONCURRENT_LRU_HPP
+
+#include "expand/lru.hpp"
+#include "mutex/spin_lock.hpp"
+#include <bit>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace anya {
+
+// 各分段的运行计数之和，由 concurrent_lru_cache::statistics() 逐个分段加锁读取
+struct concurrent_lru_statistics {
+    size_t hits;        // get/visit/get_or_compute 命中的次数
+    size_t misses;      // 未命中的次数
+    size_t evictions;   // 因为分段已满被淘汰的元素个数
+    size_t size;        // 元素个数
+    size_t capacity;    // 各分段容量之和
+    float  hit_ratio;   // hits / (hits + misses)，没有查找时为0
+};
+
+// 分段的线程安全LRU缓存
+// 按哈希值把key分到若干个分段中，每个分段是一个独立的 lru_cache 并由自己的锁保护；
+// 命中也要修改最近使用的顺序，整体一把锁时每次命中都是全局写，分段后只有落在同一分段的操作互相阻塞
+// 淘汰按分段进行：总容量平均分给各分段，某个分段满了就淘汰它自己最久没有使用的元素，因此只是近似的全局LRU
+// 值的引用无法在锁外安全使用，所以 get 返回值的拷贝，原位读写通过 visit 在锁内完成
+template<
+    class K,
+    class V,
+    class Hash     = anya::hash<K>,
+    class KeyEqual = std::equal_to<K>,
+    class Lock     = anya::spin_lock>
+class concurrent_lru_cache {
+public:
+    using key_type    = K;
+    using mapped_type = V;
+    using size_type   = size_t;
+    using hasher      = Hash;
+    using key_equal   = KeyEqual;
+    using lock_type   = Lock;
+
+private:
+    // 各分段在不同的线程上同时分配结点，不能使用全局的内存池
+    using cache_type = anya::lru_cache<K, V, Hash, KeyEqual, anya::malloc_allocator<std::pair<K, V>>>;
+    using guard_type = std::unique_lock<Lock>;
+
+    // 每个分段独占缓存行，避免相邻分段的锁互相伪共享；计数只在持锁时修改
+    struct alignas(64) shard {
+        Lock       lock;
+        cache_type cache;
+        size_t     capacity{};
+        size_t     hits{};
+        size_t     misses{};
+        size_t     evictions{};
+    };
+
+    std::unique_ptr<shard[]> shards;
+    size_t                   shard_mask;
+    hasher                   hash_fcn;
+
+    constexpr static size_t default_capacity = 1024;
+
+#pragma region 构造 && 析构
+public:
+    concurrent_lru_cache() : concurrent_lru_cache(default_capacity) {}
+
+    // 分段数取不小于shard_count的2的幂，但不超过容量，保证每个分段至少能放一个元素
+    explicit concurrent_lru_cache(size_t capacity,
+                                  size_t shard_count = default_shard_count(),
+                                  const hasher& hash = hasher())
+        : shard_mask(shard_size(capacity, shard_count) - 1), hash_fcn(hash) {
+        shards.reset(new shard[shard_mask + 1]);
+        set_capacity(capacity);
+    }
+
+    concurrent_lru_cache(const concurrent_lru_cache&) = delete;
+
+    concurrent_lru_cache&
+    operator=(const concurrent_lru_cache&) = delete;
+
+    ~concurrent_lru_cache() = default;
+#pragma endregion
+
+
+#pragma region 容量
+public:
+    // 各分段元素个数之和，并发修改时只是一个近似值
+    [[nodiscard]] size_type
+    size() const {
+        size_t total = 0;
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            guard_type guard(shards[i].lock);
+            total += shards[i].cache.size();
+        }
+        return total;
+    }
+
+    [[nodiscard]] bool
+    empty() const { return size() == 0; }
+
+    [[nodiscard]] size_type
+    capacity() const {
+        size_t total = 0;
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            guard_type guard(shards[i].lock);
+            total += shards[i].capacity;
+        }
+        return total;
+    }
+
+    [[nodiscard]] size_type
+    shard_count() const noexcept { return shard_mask + 1; }
+
+    // 总容量平均分给各分段，余数分给前面的分段；分段缩小时立即淘汰多出的元素
+    void
+    set_capacity(size_type capacity) {
+        size_t count = shard_count(), per_shard = capacity / count, rest = capacity % count;
+        for (size_t i = 0; i < count; ++i) {
+            shard& s = shards[i];
+            guard_type guard(s.lock);
+            size_t before = s.cache.size();
+            s.capacity = per_shard + (i < rest);
+            s.cache.set_max_size(s.capacity);
+            s.evictions += before - s.cache.size();
+        }
+    }
+#pragma endregion
+
+
+#pragma region 修改器
+public:
+    // 插入或更新key对应的值并标记为最近使用，返回key原来是否不存在
+    bool
+    put(const K& key, const V& value) {
+        shard& s = shard_of(key);
+        guard_type guard(s.lock);
+        return insert_locked(s, key, value);
+    }
+
+    // 返回key是否存在
+    bool
+    erase(const K& key) {
+        shard& s = shard_of(key);
+        guard_type guard(s.lock);
+        return s.cache.erase(key);
+    }
+
+    // 逐个分段清空，不是原子的；运行计数保留
+    void
+    clear() {
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            guard_type guard(shards[i].lock);
+            shards[i].cache.clear();
+        }
+    }
+#pragma endregion
+
+
+#pragma region 查找
+public:
+    // 命中时标记为最近使用并返回值的拷贝
+    [[nodiscard]] std::optional<V>
+    get(const K& key) {
+        shard& s = shard_of(key);
+        guard_type guard(s.lock);
+        V* value = lookup_locked(s, key);
+        if (value == nullptr) return std::nullopt;
+        return *value;
+    }
+
+    // 命中时标记为最近使用，并在锁内对值调用 func(V&)，返回是否命中
+    template<class F>
+    bool
+    visit(const K& key, F&& func) {
+        shard& s = shard_of(key);
+        guard_type guard(s.lock);
+        V* value = lookup_locked(s, key);
+        if (value == nullptr) return false;
+        std::forward<F>(func)(*value);
+        return true;
+    }
+
+    // 命中时返回缓存的值，否则调用 func() 计算并放入缓存
+    // 计算期间持有分段锁，同一个key并发未命中时 func 只会被调用一次，代价是同一分段的其他操作要等待计算完成
+    template<class F>
+    V
+    get_or_compute(const K& key, F&& func) {
+        shard& s = shard_of(key);
+        guard_type guard(s.lock);
+        if (V* value = lookup_locked(s, key)) return *value;
+        V value = std::forward<F>(func)();
+        insert_locked(s, key, value);
+        return value;
+    }
+
+    [[nodiscard]] bool
+    contains(const K& key) const {
+        shard& s = shard_of(key);
+        guard_type guard(s.lock);
+        return s.cache.contains(key);
+    }
+
+    // 逐个分段加锁汇总运行计数
+    [[nodiscard]] concurrent_lru_statistics
+    statistics() const {
+        concurrent_lru_statistics stats{};
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            guard_type guard(shards[i].lock);
+            stats.hits      += shards[i].hits;
+            stats.misses    += shards[i].misses;
+            stats.evictions += shards[i].evictions;
+            stats.size      += shards[i].cache.size();
+            stats.capacity  += shards[i].capacity;
+        }
+        size_t lookups = stats.hits + stats.misses;
+        stats.hit_ratio = lookups ? static_cast<float>(stats.hits) / static_cast<float>(lookups) : 0;
+        return stats;
+    }
+
+    // 运行计数清零
+    void
+    reset_statistics() {
+        for (size_t i = 0; i <= shard_mask; ++i) {
+            guard_type guard(shards[i].lock);
+            shards[i].hits = shards[i].misses = shards[i].evictions = 0;
+        }
+    }
+#pragma endregion
+
+
+#pragma region 工具函数
+private:
+    // 默认分段数为硬件线程数的4倍，至少16个
+    static size_t
+    default_shard_count() {
+        return anya::max(size_t(16), size_t(std::thread::hardware_concurrency()) * 4);
+    }
+
+    static size_t
+    shard_size(size_t capacity, size_t shard_count) {
+        size_t count = std::bit_ceil(anya::max(shard_count, size_t(1)));
+        return anya::min(count, std::bit_floor(anya::max(capacity, size_t(1))));
+    }
+
+    // 分段下标取 hash * 2^64/φ 的中间位，与分段内哈希表使用的位互不相关
+    shard&
+    shard_of(const K& key) const {
+        constexpr size_t digits = std::numeric_limits<size_t>::digits;
+        size_t code = hash_fcn(key) * anya::power2_rehash_policy::golden;
+        return shards[(code >> (digits / 2)) & shard_mask];
+    }
+
+    V*
+    lookup_locked(shard& s, const K& key) {
+        V* value = s.cache.get(key);
+        ++(value ? s.hits : s.misses);
+        return value;
+    }
+
+    bool
+    insert_locked(shard& s, const K& key, const V& value) {
+        size_t before = s.cache.size();
+        bool inserted = s.cache.push(key, value);
+        s.evictions += before + inserted - s.cache.size();
+        return inserted;
+    }
+#pragma endregion
+};
+
+}
+
+#endif //ANYA_STL_CONCURRENT_LRU_HPP
@@ -10,15 +10,28 @@
 
 namespace anya {
 
-template<class K, class V, class Hash = std::hash<K>>
+// 队列与索引的结点都由 Allocator 重新绑定后分配
+template<
+    class K,
+    class V,
+    class Hash      = anya::hash<K>,
+    class KeyEqual  = std::equal_to<K>,
+    class Allocator = anya::allocator<std::pair<K, V>>>
 class lru_cache {
 private:
     using value_type = std::pair<K, V>;
-    using iterator = typename anya::list<value_type>::iterator;
+    using list_type  = anya::list<value_type, Allocator>;
+    using iterator   = typename list_type::iterator;
+    using map_alloc  = typename Allocator::template rebind<std::pair<const K, iterator>>::other;
+    using map_type   = anya::unordered_map<K, iterator, Hash, KeyEqual, map_alloc>;
+
+    // 哈希函数和比较函数透明时，查找接口可以直接接受能与K比较的类型
+    template<class Q>
+    constexpr static bool transparent_key = map_type::is_transparent && !std::is_same_v<Q, K>;
 
 private:
-    anya::list<value_type> queue;                 // 实际存储的队列
-    anya::unordered_map<K, iterator, Hash> map;   // 建立key到迭代器的映射
+    list_type queue;                // 实际存储的队列
+    map_type map;                   // 建立key到迭代器的映射
     size_t max_size = 1024;
 
 public:
@@ -27,43 +40,69 @@ public:
     explicit lru_cache(int sz) : max_size(sz) {}
 
 public:
-    void
+    // 返回key原来是否不存在
+    bool
     push(const K& key, const V& value) {
         auto it = map.find(key);
-        // 说明是已经存在的旧数据，需要更新在queue中的位置
+        // 说明是已经存在的旧数据，原地更新后移到队头
         if (it != map.end()) {
-            queue.erase(it->second);
+            it->second->second = value;
+            promote(it->second);
+            return false;
         }
         queue.template emplace_front(key, value);
-        map[key] = queue.begin();
+        map.emplace(key, queue.begin());
         shrink_to_fit();
+        return true;
     }
 
+    // 命中时把元素移到队头并返回指向值的指针，未命中返回 nullptr
+    // 只查找一次哈希表，移动结点只修改链表指针，不分配内存也不复制值；指针在元素被淘汰或删除前有效
+    V*
+    get(const K& key) { return get_by_key(key); }
+
+    template<class Q>
+    requires transparent_key<Q>
+    V*
+    get(const Q& key) { return get_by_key(key); }
+
     V
     get_or_default(const K& key, const V& def = {}) {
-        auto it = map.find(key);
-        if (it != map.end()) {
-            queue.push_front(std::move(*(it->second))), queue.erase(it->second);
-            map[key] = queue.begin();
-            return queue.front().second;
-        }
-        return def;
+        V* value = get_by_key(key);
+        return value ? *value : def;
     }
 
-    void
-    erase(const K& key) {
-        auto it = map.find(key);
-        if (it == map.end()) return;
-        queue.erase(it->second);
-        map.erase(it);
+    template<class Q>
+    requires transparent_key<Q>
+    V
+    get_or_default(const Q& key, const V& def = {}) {
+        V* value = get_by_key(key);
+        return value ? *value : def;
     }
 
+    // 返回key是否存在
+    bool
+    erase(const K& key) { return erase_by_key(key); }
+
+    template<class Q>
+    requires transparent_key<Q>
+    bool
+    erase(const Q& key) { return erase_by_key(key); }
+
     void
     clear() { queue.clear(), map.clear(); }
 
+    [[nodiscard]] size_t
+    size() const noexcept { return queue.size(); }
+
     bool
     contains(const K& key) { return map.count(key); }
 
+    template<class Q>
+    requires transparent_key<Q>
+    bool
+    contains(const Q& key) { return map.count(key); }
+
     void
     set_max_size(size_t size) {
         max_size = size;
@@ -71,6 +110,31 @@ public:
     }
 
 private:
+    template<class Q>
+    V*
+    get_by_key(const Q& key) {
+        auto it = map.find(key);
+        if (it == map.end()) return nullptr;
+        promote(it->second);
+        return &it->second->second;
+    }
+
+    // 把结点接到队头，迭代器保持有效，map 中保存的迭代器不需要更新
+    void
+    promote(iterator it) {
+        queue.splice(queue.cbegin(), queue, it, anya::next(it));
+    }
+
+    template<class Q>
+    bool
+    erase_by_key(const Q& key) {
+        auto it = map.find(key);
+        if (it == map.end()) return false;
+        queue.erase(it->second);
+        map.erase(it);
+        return true;
+    }
+
     constexpr void
     shrink_to_fit() {
         while (queue.size() > max_size) {
@@ -0,0 +1,400 @@
+//
+// Created by Anya on 2023/8/6.
+//
+
+#ifndef ANYA_STL_HASH_HPP
+#define ANYA_STL_HASH_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <immintrin.h>
+#  define ANYA_HASH_AVX2_DISPATCH 1   // 运行时检测到 AVX2 时使用256位的实现
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+namespace anya {
+
+// 哈希函数族 anya::hash<T>，是 anya 中哈希容器默认的哈希函数
+// 整数、枚举、浮点数和指针用 splitmix64 的双射混合，低位和高位都受所有输入位的影响，步长规律的key也不会聚集
+// 字符串短时按 wyhash 的方式每次读16~48字节，长时转为 xxh3 式的8路累加，用 SSE2/AVX2 每次处理64字节
+// pair、tuple 以及没有填充字节的可平凡复制的聚合体由各成员的哈希值组合得到
+// 其他类型退回到 std::hash<T>，所以只特化了 std::hash 的自定义类型仍然可以直接使用
+// 哈希值只保证在同一平台的同一版本中稳定，没有随机种子，不用于抵御哈希碰撞攻击
+
+#pragma region 混合函数
+constexpr uint64_t hash_secret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
+// a * b 的128位乘积，高64位写回b，低64位写回a
+constexpr void
+hash_mum(uint64_t& a, uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = __uint128_t(a) * b;
+    a = uint64_t(product), b = uint64_t(product >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = uint32_t(a), lb = uint32_t(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    a = lo, b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+// 128位乘积的高低两半异或
+constexpr uint64_t
+hash_mix(uint64_t a, uint64_t b) noexcept {
+    hash_mum(a, b);
+    return a ^ b;
+}
+
+// 整数混合（splitmix64 的输出函数），是双射，每个输入位都以约1/2的概率翻转每个输出位
+constexpr uint64_t
+hash_int(uint64_t x) noexcept {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// 组合两个哈希值，与顺序有关
+inline size_t
+hash_combine(size_t seed, size_t value) noexcept {
+    return hash_mix(seed ^ hash_secret[0], value ^ hash_secret[1]);
+}
+#pragma endregion
+
+
+#pragma region 字节串哈希
+inline uint64_t
+hash_read8(const unsigned char* p) noexcept { uint64_t v; std::memcpy(&v, p, 8); return v; }
+
+inline uint64_t
+hash_read4(const unsigned char* p) noexcept { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+// 读取1~3个字节：首字节、中间字节和尾字节
+inline uint64_t
+hash_read3(const unsigned char* p, size_t n) noexcept {
+    return (uint64_t(p[0]) << 16) | (uint64_t(p[n >> 1]) << 8) | p[n - 1];
+}
+
+// 长字节串的8路累加：每次处理64字节（一个 stripe），每个64位累加器加上 (数据 ^ 密钥) 的高32位与低32位之积，
+// 相邻的累加器再加上原始数据；每16个 stripe 打乱一次累加器，避免乘积的低位一直为0
+// 标量、SSE2 和 AVX2 的实现结果完全一致
+struct hash_bulk {
+    constexpr static size_t   stripe        = 64;
+    constexpr static size_t   block_stripes = 16;
+    constexpr static size_t   threshold     = 512;   // 不小于该长度时使用累加路径，更短时三路 wyhash 更快
+    constexpr static uint64_t scramble_prime = 0x9E3779B1u;
+
+    // 由 splitmix64 生成的密钥，第i个 stripe 使用 secret[i % 8, i % 8 + 8)
+    constexpr static std::array<uint64_t, 16> secret = [] {
+        std::array<uint64_t, 16> result{};
+        uint64_t state = 0x2545F4914F6CDD1Dull;
+        for (auto& value : result) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            value = z ^ (z >> 31);
+        }
+        return result;
+    }();
+
+    constexpr static uint64_t init[8] = {
+        0xC2B2AE3Du, 0x9E3779B185EBCA87ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull,
+        0x85EBCA77C2B2AE63ull, 0x85EBCA77u, 0x27D4EB2F165667C5ull, 0x9E3779B1u
+    };
+
+    static void
+    accumulate_scalar(uint64_t* acc, const unsigned char* p, const uint64_t* key) noexcept {
+        for (size_t i = 0; i < 8; ++i) {
+            uint64_t data = hash_read8(p + 8 * i), keyed = data ^ key[i];
+            acc[i ^ 1] += data;
+            acc[i] += (keyed & 0xFFFFFFFFu) * (keyed >> 32);
+        }
+    }
+
+    static void
+    scramble_scalar(uint64_t* acc) noexcept {
+        for (size_t i = 0; i < 8; ++i) acc[i] = ((acc[i] ^ (acc[i] >> 47)) ^ secret[i]) * scramble_prime;
+    }
+
+    // 合并8个累加器
+    static uint64_t
+    merge(const uint64_t* acc, size_t len, uint64_t seed) noexcept {
+        uint64_t result = len * hash_secret[0] ^ seed;
+        for (size_t i = 0; i < 8; i += 2) result += hash_mix(acc[i] ^ secret[i + 8], acc[i + 1] ^ secret[i + 9]);
+        return hash_mix(result ^ hash_secret[2], result ^ hash_secret[3]);
+    }
+
+    static uint64_t
+    hash_scalar(const unsigned char* p, size_t len, uint64_t seed) noexcept {
+        uint64_t acc[8];
+        std::memcpy(acc, init, sizeof(acc));
+        size_t stripes = (len - 1) / stripe;   // 最后一个 stripe 取末尾的64字节单独处理，可能与前面重叠
+        for (size_t s = 0; s < stripes; ++s) {
+            accumulate_scalar(acc, p + s * stripe, secret.data() + s % 8);
+            if ((s + 1) % block_stripes == 0) scramble_scalar(acc);
+        }
+        accumulate_scalar(acc, p + len - stripe, secret.data() + 8);
+        return merge(acc, len, seed);
+    }
+
+#if defined(__SSE2__)
+    static uint64_t
+    hash_sse2(const unsigned char* p, size_t len, uint64_t seed) noexcept {
+        __m128i acc[4];
+        for (size_t i = 0; i < 4; ++i) acc[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(init + 2 * i));
+        auto accumulate = [&acc](const unsigned char* data, const uint64_t* key) {
+            for (size_t i = 0; i < 4; ++i) {
+                __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i));
+                __m128i keyed = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + 2 * i)));
+                // 每个64位通道的低32位乘以高32位
+                __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(2, 3, 0, 1)));
+                // 相邻通道交换后加上原始数据
+                __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+                acc[i] = _mm_add_epi64(acc[i], _mm_add_epi64(product, swapped));
+            }
+        };
+        const __m128i prime = _mm_set1_epi32(int(scramble_prime));
+        size_t stripes = (len - 1) / stripe;
+        for (size_t s = 0; s < stripes; ++s) {
+            accumulate(p + s * stripe, secret.data() + s % 8);
+            if ((s + 1) % block_stripes != 0) continue;
+            for (size_t i = 0; i < 4; ++i) {
+                __m128i value = _mm_xor_si128(acc[i], _mm_srli_epi64(acc[i], 47));
+                value = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret.data() + 2 * i)));
+                // 64位乘以32位常数：低32位之积加上高32位之积左移32位
+                __m128i low  = _mm_mul_epu32(value, prime);
+                __m128i high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+                acc[i] = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+            }
+        }
+        accumulate(p + len - stripe, secret.data() + 8);
+        uint64_t result[8];
+        for (size_t i = 0; i < 4; ++i) _mm_storeu_si128(reinterpret_cast<__m128i*>(result + 2 * i), acc[i]);
+        return merge(result, len, seed);
+    }
+#endif
+
+#if defined(ANYA_HASH_AVX2_DISPATCH)
+    [[gnu::target("avx2")]] static void
+    accumulate_avx2(__m256i* acc, const unsigned char* data, const uint64_t* key) noexcept {
+        for (size_t i = 0; i < 2; ++i) {
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32 * i));
+            __m256i keyed = _mm256_xor_si256(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(key + 4 * i)));
+            __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(2, 3, 0, 1)));
+            __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            acc[i] = _mm256_add_epi64(acc[i], _mm256_add_epi64(product, swapped));
+        }
+    }
+
+    // 与 SSE2 版本相同，只是一次处理4个通道；_mm256_shuffle_epi32 在两个128位半边内各自进行，相邻通道的配对不变
+    [[gnu::target("avx2")]] static uint64_t
+    hash_avx2(const unsigned char* p, size_t len, uint64_t seed) noexcept {
+        __m256i acc[2];
+        for (size_t i = 0; i < 2; ++i) acc[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(init + 4 * i));
+        const __m256i prime = _mm256_set1_epi32(int(scramble_prime));
+        size_t stripes = (len - 1) / stripe;
+        for (size_t s = 0; s < stripes; ++s) {
+            accumulate_avx2(acc, p + s * stripe, secret.data() + s % 8);
+            if ((s + 1) % block_stripes != 0) continue;
+            for (size_t i = 0; i < 2; ++i) {
+                __m256i value = _mm256_xor_si256(acc[i], _mm256_srli_epi64(acc[i], 47));
+                value = _mm256_xor_si256(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret.data() + 4 * i)));
+                __m256i low  = _mm256_mul_epu32(value, prime);
+                __m256i high = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime);
+                acc[i] = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+            }
+        }
+        accumulate_avx2(acc, p + len - stripe, secret.data() + 8);
+        uint64_t result[8];
+        for (size_t i = 0; i < 2; ++i) _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + 4 * i), acc[i]);
+        return merge(result, len, seed);
+    }
+
+    static bool
+    has_avx2() noexcept {
+        static const bool result = [] {
+            __builtin_cpu_init();
+            return bool(__builtin_cpu_supports("avx2"));
+        }();
+        return result;
+    }
+#endif
+
+    // 按CPU支持的指令集选择实现，各实现的结果相同，哈希值不随编译选项或机器变化
+    static uint64_t
+    hash(const unsigned char* p, size_t len, uint64_t seed) noexcept {
+#if defined(ANYA_HASH_AVX2_DISPATCH)
+        if (has_avx2()) return hash_avx2(p, len, seed);
+#endif
+#if defined(__SSE2__)
+        return hash_sse2(p, len, seed);
+#else
+        return hash_scalar(p, len, seed);
+#endif
+    }
+};
+
+// 任意字节串的哈希值
+inline uint64_t
+hash_bytes(const void* data, size_t len, uint64_t seed = 0) noexcept {
+    auto p = static_cast<const unsigned char*>(data);
+    if (len >= hash_bulk::threshold) return hash_bulk::hash(p, len, seed);
+    seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+    uint64_t a, b;
+    if (len <= 16) {
+        if (len >= 4) {
+            // 4~16字节：首尾各读两个可能重叠的4字节
+            size_t shift = (len >> 3) << 2;
+            a = (hash_read4(p) << 32) | hash_read4(p + shift);
+            b = (hash_read4(p + len - 4) << 32) | hash_read4(p + len - 4 - shift);
+        }
+        else if (len > 0) {
+            a = hash_read3(p, len), b = 0;
+        }
+        else {
+            a = b = 0;
+        }
+    }
+    else {
+        size_t i = len;
+        if (i > 48) {
+            // 三路独立的乘法链，每次48字节
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hash_mix(hash_read8(p) ^ hash_secret[1], hash_read8(p + 8) ^ seed);
+                see1 = hash_mix(hash_read8(p + 16) ^ hash_secret[2], hash_read8(p + 24) ^ see1);
+                see2 = hash_mix(hash_read8(p + 32) ^ hash_secret[3], hash_read8(p + 40) ^ see2);
+                p += 48, i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hash_mix(hash_read8(p) ^ hash_secret[1], hash_read8(p + 8) ^ seed);
+            p += 16, i -= 16;
+        }
+        a = hash_read8(p + i - 16), b = hash_read8(p + i - 8);
+    }
+    a ^= hash_secret[1], b ^= seed;
+    hash_mum(a, b);
+    return hash_mix(a ^ hash_secret[0] ^ len, b ^ hash_secret[1]);
+}
+#pragma endregion
+
+
+#pragma region 哈希函数族
+// 没有专门实现的类型退回到 std::hash
+template<class T>
+struct hash : std::hash<T> {};
+
+// 整数和枚举
+template<class T>
+requires std::is_integral_v<T> || std::is_enum_v<T>
+struct hash<T> {
+    size_t
+    operator()(T value) const noexcept {
+        using U = typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>, std::type_identity<T>>::type;
+        return hash_int(uint64_t(static_cast<U>(value)));
+    }
+};
+
+// 浮点数按位哈希，+0.0 与 -0.0 相等所以先归一
+template<class T>
+requires std::is_floating_point_v<T>
+struct hash<T> {
+    size_t
+    operator()(T value) const noexcept {
+        if (value == T(0)) value = T(0);
+        uint64_t bits;
+        if constexpr (sizeof(T) == sizeof(uint32_t)) bits = std::bit_cast<uint32_t>(value);
+        else if constexpr (sizeof(T) == sizeof(uint64_t)) bits = std::bit_cast<uint64_t>(value);
+        else return hash<double>{}(static_cast<double>(value));   // long double 含有填充字节，转为double
+        return hash_int(bits);
+    }
+};
+
+template<class T>
+struct hash<T*> {
+    size_t
+    operator()(T* ptr) const noexcept { return hash<uintptr_t>{}(reinterpret_cast<uintptr_t>(ptr)); }
+};
+
+template<>
+struct hash<std::nullptr_t> {
+    size_t
+    operator()(std::nullptr_t) const noexcept { return hash<uintptr_t>{}(0); }
+};
+
+// 透明的字符串哈希，std::string、std::string_view 和 const char* 得到相同的哈希值
+// 与 std::equal_to<> 搭配使用时，anya::unordered_map<std::string, V> 可以直接用 string_view 或字面量查找，不需要构造临时的 std::string
+struct string_hash {
+    using is_transparent = void;
+
+    size_t
+    operator()(std::string_view str) const noexcept { return hash_bytes(str.data(), str.size()); }
+
+    size_t
+    operator()(const std::string& str) const noexcept { return operator()(std::string_view(str)); }
+
+    size_t
+    operator()(const char* str) const noexcept { return operator()(std::string_view(str)); }
+};
+
+template<>
+struct hash<std::string> : string_hash {};
+
+template<>
+struct hash<std::string_view> : string_hash {};
+
+// 依次组合各个值的哈希值
+template<class... Args>
+size_t
+hash_values(const Args&... args) noexcept {
+    size_t seed = hash_secret[2];
+    ((seed = hash_combine(seed, hash<std::remove_cvref_t<Args>>{}(args))), ...);
+    return seed;
+}
+
+template<class A, class B>
+struct hash<std::pair<A, B>> {
+    size_t
+    operator()(const std::pair<A, B>& value) const noexcept { return hash_values(value.first, value.second); }
+};
+
+template<class... Ts>
+struct hash<std::tuple<Ts...>> {
+    size_t
+    operator()(const std::tuple<Ts...>& value) const noexcept {
+        return std::apply([](const Ts&... args) { return hash_values(args...); }, value);
+    }
+};
+
+// 没有填充字节的可平凡复制的聚合体：值相等当且仅当字节相等，直接哈希对象的字节
+// 若类型自己特化了 std::hash，则仍使用 std::hash
+template<class T>
+requires (std::is_trivially_copyable_v<T> && std::has_unique_object_representations_v<T> &&
+          !std::is_scalar_v<T> && !std::is_default_constructible_v<std::hash<T>>)
+struct hash<T> {
+    size_t
+    operator()(const T& value) const noexcept { return hash_bytes(&value, sizeof(T)); }
+};
+#pragma endregion
+
+}
+
+#endif //ANYA_STL_HASH_HPP
@@ -441,14 +441,14 @@ distance(InputIt first, InputIt last) {
 template<class InputIt>
 constexpr InputIt
 next(InputIt it, iter_difference_t<InputIt> n = 1) {
-    advance(it, n);
+    anya::advance(it, n);
     return it;
 }
 
 template<class BidirIt>
 constexpr BidirIt
 prev(BidirIt it, iter_difference_t<BidirIt> n = 1) {
-    advance(it, -n);
+    anya::advance(it, -n);
     return it;
 }
 
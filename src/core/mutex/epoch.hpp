@@ -0,0 +1,118 @@
+//
+// Created by Anya on 2023/8/12.
+//
+
+#ifndef ANYA_STL_EPOCH_HPP
+#define ANYA_STL_EPOCH_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+namespace anya {
+
+// 基于epoch的延迟回收（RCU风格）
+// 读者进入临界区时把当前的全局epoch写入自己独占的记录，离开时清零，全程没有原子读改写，也不写共享的缓存行
+// 写者摘下结点后推进全局epoch并记下推进后的值E，所有正在读的记录都不小于E时，再也没有读者能看到该结点，可以回收
+class epoch_domain {
+private:
+    // 每个线程一条记录，独占缓存行；线程退出后记录留给后来的线程复用，不会释放
+    struct alignas(64) reader_record {
+        std::atomic<uint64_t> epoch{0};       // 进入临界区时看到的全局epoch，0表示不在临界区
+        std::atomic<bool>     in_use{true};   // 是否有线程持有这条记录
+        size_t                nesting{0};     // 临界区嵌套层数，只由持有的线程访问
+        reader_record*        next{nullptr};
+    };
+
+    // 线程退出时归还记录
+    struct record_holder {
+        reader_record* record;
+
+        ~record_holder() { record->in_use.store(false, std::memory_order_release); }
+    };
+
+    std::atomic<uint64_t>       global{1};
+    std::atomic<reader_record*> records{nullptr};
+    std::mutex                  registry;
+
+public:
+    constexpr static uint64_t quiescent = std::numeric_limits<uint64_t>::max();
+
+    static epoch_domain&
+    instance() {
+        static epoch_domain domain;
+        return domain;
+    }
+
+public:
+    // 进入读临界区，可以嵌套
+    // 先写记录再读数据，seq_cst 栅栏与写者回收前的栅栏配对，保证写者要么看到这条记录，要么读者看到摘链后的数据
+    void
+    enter() {
+        reader_record* record = local_record();
+        if (record->nesting++ != 0) return;
+        record->epoch.store(global.load(std::memory_order_acquire), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    void
+    leave() {
+        reader_record* record = local_record();
+        if (--record->nesting == 0) record->epoch.store(0, std::memory_order_release);
+    }
+
+    // 写者摘下结点后调用，返回该结点的回收epoch
+    uint64_t
+    advance() { return global.fetch_add(1, std::memory_order_seq_cst) + 1; }
+
+    // 正在读的记录中最小的epoch，没有读者时返回 quiescent；回收epoch不大于它的结点都可以释放
+    [[nodiscard]] uint64_t
+    min_active() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t result = quiescent;
+        for (auto record = records.load(std::memory_order_acquire); record; record = record->next) {
+            uint64_t epoch = record->epoch.load(std::memory_order_acquire);
+            if (epoch != 0 && epoch < result) result = epoch;
+        }
+        return result;
+    }
+
+private:
+    reader_record*
+    local_record() {
+        thread_local record_holder holder{acquire_record()};
+        return holder.record;
+    }
+
+    // 优先复用已退出线程的记录，否则新建一条挂到链表头
+    reader_record*
+    acquire_record() {
+        for (auto record = records.load(std::memory_order_acquire); record; record = record->next) {
+            bool expected = false;
+            if (record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) return record;
+        }
+        std::lock_guard guard(registry);
+        auto record = new reader_record;
+        record->next = records.load(std::memory_order_relaxed);
+        records.store(record, std::memory_order_release);
+        return record;
+    }
+};
+
+// 读临界区的RAII守卫，守卫存活期间读到的结点不会被回收
+class epoch_guard {
+public:
+    epoch_guard() { epoch_domain::instance().enter(); }
+
+    epoch_guard(const epoch_guard&) = delete;
+
+    epoch_guard&
+    operator=(const epoch_guard&) = delete;
+
+    ~epoch_guard() { epoch_domain::instance().leave(); }
+};
+
+}
+
+#endif //ANYA_STL_EPOCH_HPP
@@ -6,6 +6,8 @@
 #define ANYA_STL_SPIN_LOCK_HPP
 
 #include <atomic>
+#include <cstddef>
+#include <thread>
 
 namespace anya {
 
@@ -13,18 +15,31 @@ class spin_lock {
 private:
     std::atomic_flag flag;
 
+    constexpr static size_t max_spins = 64;
+
 public:
     spin_lock() : flag(ATOMIC_FLAG_INIT) {}
 
 public:
     // 尝试获取自旋锁，直到返回的旧值为false时，说明当前线程已经成功获取锁，将flag设置为true了
     // test_and_set 先测试旧值是否是false，是的话则设置为true并返回旧值false，否则将一直返回true
+    // 抢锁失败后只读等待flag变为false再重试，等待期间不会反复写缓存行
+    // 自旋一定次数仍未等到时让出时间片，避免持锁线程被抢占后其他线程空转整个时间片
     void
-    lock() { while(flag.test_and_set(std::memory_order_acquire)); }
-
-    // 放弃自旋锁，当前线程把flag设置为false
+    lock() {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+            for (size_t spins = 0; flag.test(std::memory_order_relaxed); ++spins) {
+                if (spins >= max_spins) std::this_thread::yield(), spins = 0;
+            }
+        }
+    }
+
+    bool
+    try_lock() { return !flag.test_and_set(std::memory_order_acquire); }
+
+    // 放弃自旋锁，当前线程把flag设置为false，release保证临界区内的写入对下一个持锁线程可见
     void
-    unlock() { flag.clear(std::memory_order_acquire); }
+    unlock() { flag.clear(std::memory_order_release); }
 };
 
 }
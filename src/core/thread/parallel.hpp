@@ -0,0 +1,29 @@
+//
+// Created by Anya on 2023/8/24.
+//
+
+#ifndef ANYA_STL_PARALLEL_HPP
+#define ANYA_STL_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+
+namespace anya {
+
+// 默认的线程数：硬件线程数，无法获取时为1
+inline size_t
+default_concurrency() noexcept {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// 让每个线程至少处理 grain 个元素，n个元素最多用 threads 个线程，threads 为0时取 default_concurrency()
+inline size_t
+parallel_threads(size_t n, size_t threads, size_t grain) noexcept {
+    if (threads == 0) threads = default_concurrency();
+    return std::clamp(n / std::max(grain, size_t(1)), size_t(1), threads);
+}
+
+}
+
+#endif //ANYA_STL_PARALLEL_HPP
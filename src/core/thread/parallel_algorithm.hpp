@@ -0,0 +1,61 @@
+//
+// Created by Anya on 2023/8/25.
+//
+
+#ifndef ANYA_STL_PARALLEL_ALGORITHM_HPP
+#define ANYA_STL_PARALLEL_ALGORITHM_HPP
+
+#include "container/vector.hpp"
+#include "thread/thread_pool.hpp"
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace anya {
+
+// 容器的遍历被切成多少段：段数多于线程数，链长不均时由先做完的线程多领几段
+constexpr size_t parallel_split_factor = 4;
+
+// 恒等变换，parallel_reduce 默认直接归约元素本身
+struct parallel_identity {
+    template<class T>
+    constexpr T&&
+    operator()(T&& value) const noexcept { return std::forward<T>(value); }
+};
+
+// 在线程池上对容器的每个元素调用 f，容器需要提供 split(parts)，返回首尾相接的迭代器对
+// 默认使用 default_thread_pool()，与哈希表的 insert_parallel 和并行rehash共用同一组工作线程
+// f 会在多个线程中同时调用，遍历期间不能修改容器的结构；f 抛出异常时其余段照常遍历，结束后重新抛出第一个异常
+template<class Container, class F>
+void
+parallel_for_each(Container& container, F f, thread_pool& pool = default_thread_pool()) {
+    auto ranges = container.split(pool.size() * parallel_split_factor);
+    pool.run(ranges.size(), [&](size_t i) {
+        for (auto it = ranges[i].first; it != ranges[i].second; ++it) f(*it);
+    });
+}
+
+// 在线程池上计算 reduce(...reduce(reduce(init, transform(x1)), transform(x2))..., transform(xn))
+// 每段先各自归约，再按遍历顺序合并，reduce 需要满足结合律；transform 与 reduce 都会在多个线程中同时调用
+template<class Container, class T, class Reduce = std::plus<>, class Transform = parallel_identity>
+T
+parallel_reduce(Container& container, T init, Reduce reduce = Reduce(), Transform transform = Transform(),
+                thread_pool& pool = default_thread_pool()) {
+    auto ranges = container.split(pool.size() * parallel_split_factor);
+    anya::vector<std::optional<T>> partials(ranges.size());
+    pool.run(ranges.size(), [&](size_t i) {
+        auto it = ranges[i].first, last = ranges[i].second;
+        if (it == last) return;
+        T result = transform(*it);
+        while (++it != last) result = reduce(std::move(result), transform(*it));
+        partials[i] = std::move(result);
+    });
+    for (auto& partial : partials) {
+        if (partial) init = reduce(std::move(init), std::move(*partial));
+    }
+    return init;
+}
+
+}
+
+#endif //ANYA_STL_PARALLEL_ALGORITHM_HPP
@@ -0,0 +1,148 @@
+//
+// Created by Anya on 2023/8/25.
+//
+
+#ifndef ANYA_STL_THREAD_POOL_HPP
+#define ANYA_STL_THREAD_POOL_HPP
+
+#include "thread/parallel.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace anya {
+
+// 固定大小的线程池，线程在构造时创建、析构时回收，反复执行并行任务时不再创建线程
+// 调用 run 的线程也参与执行，所以 size() 个线程中有 size() - 1 个是池中的工作线程；
+// 任务中可以再调用 run，多个线程也可以同时调用 run
+class thread_pool {
+private:
+    // 一次 run 的状态，迟到的工作线程只会访问计数器，所以由 shared_ptr 保证在 run 返回后仍然有效
+    struct batch {
+        std::atomic<size_t>     next{0};
+        std::atomic<size_t>     done{0};
+        size_t                  tasks;
+        void*                   task;
+        void                    (*invoke)(void*, size_t);
+        std::exception_ptr      error;
+        std::mutex              lock;
+        std::condition_variable finished;
+
+        // 领取并执行任务，直到没有剩余的任务
+        void
+        work() {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < tasks;) {
+                try {
+                    invoke(task, i);
+                }
+                catch (...) {
+                    std::lock_guard guard(lock);
+                    if (!error) error = std::current_exception();
+                }
+                if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == tasks) {
+                    std::lock_guard guard(lock);
+                    finished.notify_all();
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread>           workers;
+    std::deque<std::shared_ptr<batch>> pending;   // 等待工作线程参与的批次，每个元素代表一个线程的名额
+    std::mutex                         lock;
+    std::condition_variable            wakeup;
+    bool                               stopping = false;
+
+public:
+    // threads 为总的并行度，包括调用 run 的线程，为0时取硬件线程数
+    explicit
+    thread_pool(size_t threads = 0) {
+        if (threads == 0) threads = default_concurrency();
+        workers.reserve(threads - 1);
+        try {
+            for (size_t i = 1; i < threads; ++i) workers.emplace_back([this] { loop(); });
+        }
+        catch (...) {
+            stop();
+            throw;
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+
+    thread_pool&
+    operator=(const thread_pool&) = delete;
+
+    ~thread_pool() { stop(); }
+
+    [[nodiscard]] size_t
+    size() const noexcept { return workers.size() + 1; }
+
+    // 执行 task(0) ~ task(tasks - 1)，全部完成后返回；任务按下标动态领取，各任务之间不保证顺序
+    // 某个任务抛出异常时其余任务照常执行，结束后重新抛出第一个异常
+    template<class F>
+    void
+    run(size_t tasks, F&& task) {
+        if (tasks == 0) return;
+        if (tasks == 1 || workers.empty()) {
+            for (size_t i = 0; i < tasks; ++i) task(i);
+            return;
+        }
+        auto current = std::make_shared<batch>();
+        current->tasks  = tasks;
+        current->task   = std::addressof(task);
+        current->invoke = [](void* f, size_t i) { (*static_cast<std::remove_reference_t<F>*>(f))(i); };
+        {
+            std::lock_guard guard(lock);
+            for (size_t i = 1, n = std::min(tasks, size()); i < n; ++i) pending.push_back(current);
+        }
+        wakeup.notify_all();
+        current->work();
+        std::unique_lock guard(current->lock);
+        current->finished.wait(guard, [&] { return current->done.load(std::memory_order_acquire) == tasks; });
+        if (current->error) std::rethrow_exception(current->error);
+    }
+
+private:
+    void
+    loop() {
+        for (;;) {
+            std::shared_ptr<batch> current;
+            {
+                std::unique_lock guard(lock);
+                wakeup.wait(guard, [this] { return stopping || !pending.empty(); });
+                if (pending.empty()) return;
+                current = std::move(pending.front());
+                pending.pop_front();
+            }
+            current->work();
+        }
+    }
+
+    void
+    stop() noexcept {
+        {
+            std::lock_guard guard(lock);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& thread : workers) thread.join();
+        workers.clear();
+    }
+};
+
+// 进程内共享的线程池，并行度为硬件线程数，第一次使用时创建
+inline thread_pool&
+default_thread_pool() {
+    static thread_pool pool;
+    return pool;
+}
+
+}
+
+#endif //ANYA_STL_THREAD_POOL_HPP
@@ -8,9 +8,21 @@
 #include "tests/queue_test.hpp"
 #include "tests/heap_test.hpp"
 #include "tests/priority_queue_test.hpp"
+#include "tests/hash_test.hpp"
 #include "tests/hashtable_test.hpp"
 #include "tests/unordered_map_test.hpp"
+#include "tests/unordered_set_test.hpp"
+#include "tests/unordered_multiset_test.hpp"
+#include "tests/unordered_multimap_test.hpp"
 #include "tests/lru_test.hpp"
+#include "tests/concurrent_unordered_map_test.hpp"
+#include "tests/rcu_unordered_map_test.hpp"
+#include "tests/hash_image_test.hpp"
+#include "tests/frozen_test.hpp"
+#include "tests/parallel_test.hpp"
+#include "tests/string_unordered_map_test.hpp"
+#include "tests/compact_test.hpp"
+#include "tests/concurrent_lru_test.hpp"
 #include <iterator>
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,147 @@
+//
+// Created by Anya on 2023/8/27.
+//
+
+#ifndef ANYA_STL_COMPACT_TEST_HPP
+#define ANYA_STL_COMPACT_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/compact_list.hpp"
+#include "container/compact_unordered_map.hpp"
+#include "container/compact_unordered_set.hpp"
+#include "container/list.hpp"
+#include <list>
+#include <string>
+#include <unordered_map>
+
+TEST(CompactTest, list) {
+    anya::compact_list<int> list{1, 2, 3};
+    std::list<int> std{1, 2, 3};
+    list.push_front(0), std.push_front(0);
+    list.emplace_back(4), std.emplace_back(4);
+    auto pos = list.insert(anya::next(list.cbegin(), 2), 3, 9);
+    std.insert(std::next(std.cbegin(), 2), 3, 9);
+    EXPECT_TRUE(*pos == 9 && anya::equal(list.begin(), list.end(), std.begin()));
+    EXPECT_TRUE(list.front() == 0 && list.back() == 4 && list.size() == std.size());
+    EXPECT_TRUE(list.remove(9) == 3);
+    std.remove(9);
+    EXPECT_TRUE(anya::equal(list.rbegin(), list.rend(), std.rbegin()));
+
+    // 删除的结点被复用，迭代器在扩容后仍然有效
+    auto it = list.begin();
+    list.pop_front(), list.pop_front();
+    std.pop_front(), std.pop_front();
+    size_t capacity = list.capacity();
+    list.push_back(5), list.push_back(6);
+    std.push_back(5), std.push_back(6);
+    EXPECT_TRUE(list.capacity() == capacity);
+    it = list.begin();
+    for (int i = 0; i < 1000; ++i) list.push_back(i), std.push_back(i);
+    EXPECT_TRUE(*it == 2 && anya::equal(list.begin(), list.end(), std.begin()));
+
+    list.reverse(), std.reverse();
+    EXPECT_TRUE(anya::equal(list.begin(), list.end(), std.begin()));
+    list.sort(), std.sort();
+    EXPECT_TRUE(anya::equal(list.begin(), list.end(), std.begin()));
+    list.unique(), std.unique();
+    EXPECT_TRUE(list.size() == std.size() && anya::equal(list.begin(), list.end(), std.begin()));
+
+    // 复制与按顺序重排
+    anya::compact_list<int> copy(list);
+    EXPECT_TRUE(copy == list);
+    copy.erase(copy.begin(), anya::next(copy.begin(), 10));
+    copy.shrink_to_fit();
+    EXPECT_TRUE(copy.capacity() == copy.size() && anya::equal(copy.begin(), copy.end(), anya::next(list.begin(), 10)));
+    copy.clear();
+    EXPECT_TRUE(copy.empty() && copy.begin() == copy.end());
+}
+
+TEST(CompactTest, list_non_trivial) {
+    anya::compact_list<std::string> list;
+    for (int i = 0; i < 100; ++i) list.push_back(std::string(40, 'a' + i % 26));
+    // 有空闲结点时扩容只移动存放着元素的结点
+    list.remove_if([](const std::string& s) { return s[0] < 'm'; });
+    list.reserve(1000);
+    EXPECT_TRUE(list.size() == 52 && list.front() == std::string(40, 'm'));
+    anya::compact_list<std::string> copy = list;
+    list.resize(10);
+    copy.resize(60, "x");
+    EXPECT_TRUE(list.size() == 10 && copy.size() == 60 && copy.back() == "x");
+    EXPECT_TRUE(anya::equal(list.begin(), list.end(), copy.begin()));
+    // 链接的开销只有 list 的一半
+    EXPECT_TRUE(list.memory_usage() <= list.capacity() * (sizeof(std::string) + 8) + 8);
+}
+
+TEST(CompactTest, self_insert) {
+    // 元素数组满了时插入容器中已有的元素，扩容不能让参数引用的元素先被释放
+    anya::compact_list<std::string> list;
+    for (int i = 0; i < 16; ++i) list.push_back(std::string(40, 'a' + i));
+    EXPECT_TRUE(list.capacity() == 16);
+    list.push_back(list.front());
+    list.push_front(list.back());
+    EXPECT_TRUE(list.size() == 18 && list.front() == std::string(40, 'a') && list.back() == std::string(40, 'a'));
+
+    anya::compact_unordered_map<int, std::string> map;
+    for (int i = 0; i < 16; ++i) map.emplace(i, std::string(40, 'a' + i));
+    // key已经存在时不会扩容
+    size_t usage = map.memory_usage();
+    EXPECT_FALSE(map.insert(*map.begin()).second);
+    EXPECT_TRUE(map.size() == 16 && map.memory_usage() == usage);
+    int first = map.begin()->first;
+    EXPECT_TRUE(map.emplace(16, map.begin()->second).second && map.at(16) == map.at(first));
+    for (int i = 17; i < 32; ++i) map.emplace(i, std::string(40, 'a' + i % 26));
+    EXPECT_TRUE(map.try_emplace(32, map.at(31)).second && map.at(32) == std::string(40, 'a' + 31 % 26));
+}
+
+TEST(CompactTest, map) {
+    anya::compact_unordered_map<int, int> map;
+    std::unordered_map<int, int> std;
+    for (int i = 0; i < 20000; ++i) {
+        int key = i * 7919 % 12000;
+        map[key] += i, std[key] += i;
+    }
+    EXPECT_TRUE(map.size() == std.size() && map.load_factor() <= map.max_load_factor());
+    for (auto& [key, value] : std) EXPECT_TRUE(map.at(key) == value);
+    EXPECT_TRUE(map.try_emplace(0, -1).second == false && map.insert({-1, -1}).second);
+    EXPECT_THROW(map.at(-2), std::out_of_range);
+    EXPECT_TRUE(map.erase(-1) == 1 && !map.contains(-1));
+
+    // 删除时最后一个元素移到空出的位置，返回的迭代器指向它
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->first % 3 == 0) it = map.erase(it);
+        else ++it;
+    }
+    std::erase_if(std, [](auto& kv) { return kv.first % 3 == 0; });
+    EXPECT_TRUE(map.size() == std.size());
+    for (auto& [key, value] : map) EXPECT_TRUE(std.at(key) == value);
+    for (auto& [key, value] : std) EXPECT_TRUE(map.at(key) == value);
+
+    auto copy = map;
+    EXPECT_TRUE(copy == map);
+    copy.rehash(0);
+    EXPECT_TRUE(copy == map);
+    auto moved = std::move(copy);
+    EXPECT_TRUE(moved == map && copy.empty() && !copy.contains(1));
+    copy[1] = 1;
+    EXPECT_TRUE(copy.at(1) == 1);
+    map.clear();
+    EXPECT_TRUE(map.empty() && map.begin() == map.end() && !map.contains(1));
+
+    // 每个元素只多4字节链接
+    anya::compact_unordered_map<int, int> reserved;
+    reserved.reserve(1000);
+    EXPECT_TRUE(reserved.memory_usage() == 1000 * (sizeof(std::pair<const int, int>) + 4) + reserved.bucket_count() * 4);
+}
+
+TEST(CompactTest, set) {
+    anya::compact_unordered_set<std::string> set{"a", "b", "c"};
+    EXPECT_TRUE(set.size() == 3 && set.contains("b") && !set.insert("b").second);
+    set.erase("a");
+    EXPECT_TRUE(set.size() == 2 && !set.contains("a") && set.contains("c"));
+    size_t visited = 0;
+    for (auto& key : set) visited += key.size();
+    EXPECT_TRUE(visited == 2);
+}
+
+#endif //ANYA_STL_COMPACT_TEST_HPP
@@ -0,0 +1,92 @@
+//
+// Created by Anya on 2023/8/29.
+//
+
+#ifndef ANYA_STL_CONCURRENT_LRU_TEST_HPP
+#define ANYA_STL_CONCURRENT_LRU_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "expand/concurrent_lru.hpp"
+#include "functional/hash.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentLRUTest, basic) {
+    anya::concurrent_lru_cache<std::string, int> lru(10, 3);
+    EXPECT_TRUE(lru.shard_count() == 4 && lru.capacity() == 10);
+    EXPECT_TRUE(lru.empty());
+    EXPECT_TRUE(lru.put("anya", 0));
+    EXPECT_FALSE(lru.put("anya", 1));
+    EXPECT_TRUE(lru.get("anya") == 1);
+    EXPECT_FALSE(lru.get("loid").has_value());
+    EXPECT_TRUE(lru.visit("anya", [](int& v) { v += 1; }));
+    EXPECT_FALSE(lru.visit("loid", [](int& v) { v += 1; }));
+    EXPECT_TRUE(lru.get_or_compute("anya", [] { return -1; }) == 2);
+    EXPECT_TRUE(lru.get_or_compute("yor", [] { return 3; }) == 3);
+    EXPECT_TRUE(lru.contains("yor") && lru.size() == 2);
+    EXPECT_TRUE(lru.erase("yor") && !lru.erase("yor"));
+
+    auto stats = lru.statistics();
+    EXPECT_TRUE(stats.hits == 3 && stats.misses == 3 && stats.evictions == 0);
+    EXPECT_TRUE(stats.size == 1 && stats.capacity == 10 && stats.hit_ratio == 0.5f);
+    lru.reset_statistics();
+    EXPECT_TRUE(lru.statistics().hits == 0);
+    lru.clear();
+    EXPECT_TRUE(lru.empty());
+
+    // 分段数不超过容量，每个分段至少放一个元素
+    anya::concurrent_lru_cache<int, int> small(3, 16);
+    EXPECT_TRUE(small.shard_count() == 2 && small.capacity() == 3);
+}
+
+TEST(ConcurrentLRUTest, eviction) {
+    // 只有一个分段时就是精确的LRU
+    anya::concurrent_lru_cache<int, int> lru(100, 1);
+    for (int i = 0; i < 100; ++i) lru.put(i, i);
+    for (int i = 0; i < 50; ++i) EXPECT_TRUE(lru.get(i) == i);
+    for (int i = 100; i < 150; ++i) lru.put(i, i);
+    for (int i = 0; i < 50; ++i) EXPECT_TRUE(lru.contains(i));
+    for (int i = 50; i < 100; ++i) EXPECT_FALSE(lru.contains(i));
+    EXPECT_TRUE(lru.statistics().evictions == 50 && lru.size() == 100);
+
+    // 多个分段时总元素数不超过总容量，缩小容量时立即淘汰
+    anya::concurrent_lru_cache<int, int> sharded(1000, 8);
+    for (int i = 0; i < 5000; ++i) sharded.put(i, i);
+    auto stats = sharded.statistics();
+    EXPECT_TRUE(stats.size <= 1000 && stats.size + stats.evictions == 5000);
+    sharded.set_capacity(80);
+    EXPECT_TRUE(sharded.size() <= 80 && sharded.capacity() == 80);
+    EXPECT_TRUE(sharded.statistics().evictions == 5000 - sharded.size());
+}
+
+TEST(ConcurrentLRUTest, concurrent) {
+    anya::concurrent_lru_cache<int, int, anya::hash<int>, std::equal_to<int>, std::mutex> lru(4096, 8);
+    constexpr int threads = 4, per_thread = 20000;
+    std::atomic<int> computed{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&lru, &computed, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                int key = (i * 7 + t) % 2048;
+                lru.get_or_compute(key, [&] { return ++computed, key * 2; });
+                // 其他线程的插入可能刚好把它淘汰
+                auto value = lru.get(key);
+                if (value) {
+                    EXPECT_TRUE(*value == key * 2);
+                }
+                if (i % 16 == 0) lru.put(per_thread + t * per_thread + i, 0);
+                if (i % 64 == 0) lru.erase(per_thread + t * per_thread + i);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    auto stats = lru.statistics();
+    EXPECT_TRUE(stats.size <= 4096 && stats.size == lru.size());
+    EXPECT_TRUE(stats.hits + stats.misses == 2 * threads * per_thread);
+    EXPECT_TRUE(stats.misses >= size_t(computed.load()));
+}
+
+#endif //ANYA_STL_CONCURRENT_LRU_TEST_HPP
@@ -0,0 +1,69 @@
+//
+// Created by Anya on 2023/8/9.
+//
+
+#ifndef ANYA_STL_CONCURRENT_UNORDERED_MAP_TEST_HPP
+#define ANYA_STL_CONCURRENT_UNORDERED_MAP_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/concurrent_unordered_map.hpp"
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentUnorderedMapTest, basic) {
+    anya::concurrent_unordered_map<int, int> map(3);
+    EXPECT_TRUE(map.shard_count() == 4);
+    EXPECT_TRUE(map.empty());
+    EXPECT_TRUE(map.emplace(1, 1));
+    EXPECT_FALSE(map.emplace(1, 2));
+    EXPECT_TRUE(map.find(1) == 1);
+    EXPECT_FALSE(map.insert_or_assign(1, 3));
+    EXPECT_TRUE(map.find(1) == 3);
+    EXPECT_TRUE(map.visit(1, [](int& v) { v += 1; }));
+    EXPECT_TRUE(map.find(1) == 4);
+    EXPECT_FALSE(map.visit(2, [](int& v) { v += 1; }));
+    EXPECT_TRUE(map.compute_if_absent(1, [] { return 0; }) == 4);
+    EXPECT_TRUE(map.compute_if_absent(2, [] { return 5; }) == 5);
+    EXPECT_TRUE(map.size() == 2);
+    EXPECT_TRUE(map.erase(1) == 1 && map.erase(1) == 0);
+    EXPECT_FALSE(map.find(1).has_value());
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(ConcurrentUnorderedMapTest, concurrent) {
+    anya::concurrent_unordered_map<int, int> map(8);
+    constexpr int threads = 4, per_thread = 20000;
+    std::vector<std::thread> workers;
+    std::atomic<int> computed{0};
+    for (int i = 0; i < 100; ++i) map.emplace(i, i);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&map, &computed, t] {
+            for (int i = t * per_thread; i < (t + 1) * per_thread; ++i) map.emplace(i, i);
+            // 所有线程争抢同一批key，func 对每个key只会被调用一次
+            for (int i = 0; i < 1000; ++i) map.compute_if_absent(-1 - i, [&] { return ++computed, i; });
+            for (int i = 0; i < per_thread; ++i) map.visit(i % 100, [](int& v) { ++v; });
+            for (int i = t * per_thread; i < (t + 1) * per_thread; i += 2) map.erase(i);
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    EXPECT_TRUE(computed == 1000);
+    EXPECT_TRUE(map.size() == threads * per_thread / 2 + 1000);
+    for (int i = 1; i < 100; i += 2) EXPECT_TRUE(map.find(i) == i + threads * per_thread / 100);
+    size_t visited = 0;
+    map.for_each([&visited](const auto&) { ++visited; });
+    EXPECT_TRUE(visited == map.size());
+}
+
+TEST(ConcurrentUnorderedMapTest, shared_mutex) {
+    anya::concurrent_unordered_map<std::string, int, std::hash<std::string>,
+                                   std::equal_to<std::string>, std::shared_mutex> map;
+    map.incremental_rehash(4);
+    for (int i = 0; i < 1000; ++i) map.emplace(std::to_string(i), i);
+    for (int i = 0; i < 1000; ++i) EXPECT_TRUE(map.find(std::to_string(i)) == i);
+    EXPECT_TRUE(map.contains("999") && !map.contains("anya"));
+}
+
+#endif //ANYA_STL_CONCURRENT_UNORDERED_MAP_TEST_HPP
@@ -315,4 +315,40 @@ TEST(DequeTest, swap) {
     EXPECT_TRUE(anya1 == anya2);
 }
 
+TEST(DequeTest, buffer_boundary) {
+    // 元素跨越多个 node，finish 正好落在 node 开头时下一个 node 也已经分配
+    anya::deque<int> anya;
+    std::deque<int> stand;
+    for (int i = 0; i < 2000; ++i) anya.push_back(i), stand.push_back(i);
+    for (int i = 1; i <= 300; ++i) anya.push_front(-i), stand.push_front(-i);
+    EXPECT_TRUE(anya.size() == stand.size() && std::equal(stand.begin(), stand.end(), anya.begin()));
+    EXPECT_TRUE(std::equal(stand.rbegin(), stand.rend(), anya.rbegin()));
+
+    // 区间删除只移动较短的一侧
+    anya::deque<int> range{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    auto it = range.erase(range.begin() + 1, range.begin() + 3);
+    EXPECT_TRUE(*it == 3 && range.size() == 8 && range.front() == 0);
+    it = range.erase(range.end() - 3, range.end() - 1);
+    EXPECT_TRUE(*it == 9 && range.size() == 6 && range.back() == 9);
+    EXPECT_TRUE(range == (anya::deque<int>{0, 3, 4, 5, 6, 9}));
+
+    // 跨越 node 的区间删除
+    anya.erase(anya.begin() + 100, anya.begin() + 400);
+    stand.erase(stand.begin() + 100, stand.begin() + 400);
+    anya.erase(anya.end() - 400, anya.end() - 100);
+    stand.erase(stand.end() - 400, stand.end() - 100);
+    EXPECT_TRUE(anya.size() == stand.size() && std::equal(stand.begin(), stand.end(), anya.begin()));
+}
+
+TEST(DequeTest, erase_if) {
+    anya::deque<int> anya;
+    std::deque<int> stand;
+    for (int i = 0; i < 2000; ++i) anya.push_back(i), stand.push_back(i);
+    auto odd = [](int x) { return x % 3 != 0; };
+    EXPECT_EQ(anya::erase_if(anya, odd), std::erase_if(stand, odd));
+    EXPECT_TRUE(anya.size() == stand.size() && std::equal(stand.begin(), stand.end(), anya.begin()));
+    anya.push_front(-1), anya.push_back(2001);
+    EXPECT_TRUE(anya.front() == -1 && anya.back() == 2001 && anya[1] == 0);
+}
+
 #endif //ANYA_STL_DEQUE_TEST_HPP
@@ -0,0 +1,104 @@
+//
+// Created by Anya on 2023/8/22.
+//
+
+#ifndef ANYA_STL_FROZEN_TEST_HPP
+#define ANYA_STL_FROZEN_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/frozen_map.hpp"
+#include "container/frozen_set.hpp"
+#include "container/frozen_unordered_map.hpp"
+#include "container/unordered_map.hpp"
+#include <string>
+#include <string_view>
+
+enum class frozen_opcode { nop, load, store, jump, halt };
+
+constexpr auto frozen_opcodes = anya::make_frozen_map<std::string_view, frozen_opcode>({
+    {"nop", frozen_opcode::nop}, {"load", frozen_opcode::load}, {"store", frozen_opcode::store},
+    {"jump", frozen_opcode::jump}, {"halt", frozen_opcode::halt},
+});
+
+// 查找在编译期完成
+static_assert(frozen_opcodes.size() == 5);
+static_assert(frozen_opcodes.at("store") == frozen_opcode::store);
+static_assert(!frozen_opcodes.contains("stor"));
+static_assert(anya::make_frozen_set<int>({2, 3, 5, 7, 11, 13}).contains(11));
+static_assert(anya::make_frozen_set<frozen_opcode>({frozen_opcode::jump}).count(frozen_opcode::halt) == 0);
+
+TEST(FrozenTest, map) {
+    EXPECT_TRUE(frozen_opcodes.at("load") == frozen_opcode::load);
+    EXPECT_TRUE(frozen_opcodes.find("halt")->second == frozen_opcode::halt);
+    EXPECT_TRUE(frozen_opcodes.find("") == frozen_opcodes.end());
+    EXPECT_THROW((void) frozen_opcodes.at("loads"), std::out_of_range);
+    std::string key = "jump";
+    EXPECT_TRUE(frozen_opcodes.contains(key));
+
+    // 遍历顺序与初始化顺序相同
+    size_t i = 0;
+    for (auto& [name, op] : frozen_opcodes) EXPECT_TRUE(static_cast<size_t>(op) == i++);
+    EXPECT_TRUE(i == frozen_opcodes.size());
+
+    constexpr auto squares = anya::make_frozen_map<int, int>({
+        {1, 1}, {2, 4}, {3, 9}, {4, 16}, {5, 25}, {6, 36}, {7, 49}, {8, 64}, {9, 81}, {10, 100},
+    });
+    for (int k = -100; k <= 100; ++k) {
+        auto it = squares.find(k);
+        EXPECT_TRUE(k >= 1 && k <= 10 ? it != squares.end() && it->second == k * k : it == squares.end());
+    }
+}
+
+TEST(FrozenTest, set) {
+    constexpr auto keywords = anya::make_frozen_set<std::string_view>({
+        "alignas", "alignof", "auto", "bool", "break", "case", "catch", "char", "class", "const",
+        "constexpr", "continue", "default", "delete", "do", "double", "else", "enum", "explicit", "extern",
+        "false", "float", "for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+        "namespace", "new", "noexcept", "nullptr", "operator", "private", "protected", "public", "return", "short",
+        "signed", "sizeof", "static", "struct", "switch", "template", "this", "throw", "true", "try",
+        "typedef", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "while",
+    });
+    EXPECT_TRUE(keywords.size() == 59);
+    for (auto word : keywords) EXPECT_TRUE(keywords.contains(word));
+    for (std::string_view word : {"Auto", "classes", "integer", "", "whilst", "a_very_long_identifier_name"}) {
+        EXPECT_FALSE(keywords.contains(word));
+    }
+}
+
+TEST(FrozenTest, freeze) {
+    anya::unordered_map<int, int> map;
+    for (int i = 0; i < 100000; ++i) map.emplace(i * 3, i);
+    auto frozen = map.freeze();
+    EXPECT_TRUE(frozen.size() == map.size());
+    EXPECT_TRUE(frozen.bucket_count() < frozen.size());
+    for (int i = -10; i < 300010; ++i) {
+        auto it = frozen.find(i);
+        EXPECT_TRUE(i >= 0 && i < 300000 && i % 3 == 0 ? it != frozen.end() && it->second == i / 3 : it == frozen.end());
+    }
+    size_t visited = 0;
+    for (auto& [key, value] : frozen) visited += map.at(key) == value;
+    EXPECT_TRUE(visited == map.size());
+
+    anya::frozen_unordered_map<std::string, int> empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_FALSE(empty.contains("a"));
+}
+
+TEST(FrozenTest, runtime) {
+    anya::frozen_unordered_map<std::string, int, anya::string_hash, std::equal_to<>> words = {{"one", 1}, {"two", 2}, {"three", 3}};
+    EXPECT_TRUE(words.at("three") == 3);
+    EXPECT_TRUE(words.count("four") == 0);
+    EXPECT_TRUE(words.find(std::string_view("two"))->second == 2);
+    EXPECT_THROW((void) words.at("four"), std::out_of_range);
+    EXPECT_THROW((anya::frozen_unordered_map<std::string, int>{{"one", 1}, {"one", 2}}), std::invalid_argument);
+
+    anya::vector<std::pair<std::string, int>> source;
+    for (int i = 0; i < 1000; ++i) source.emplace_back("key" + std::to_string(i), i);
+    anya::frozen_unordered_map<std::string, int> frozen(source.begin(), source.end());
+    for (int i = 0; i < 1000; ++i) EXPECT_TRUE(frozen.at("key" + std::to_string(i)) == i);
+    auto copy = frozen;
+    EXPECT_TRUE(copy == frozen);
+}
+
+#endif //ANYA_STL_FROZEN_TEST_HPP
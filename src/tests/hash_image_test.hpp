@@ -0,0 +1,89 @@
+//
+// Created by Anya on 2023/8/18.
+//
+
+#ifndef ANYA_STL_HASH_IMAGE_TEST_HPP
+#define ANYA_STL_HASH_IMAGE_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/hash_image.hpp"
+#include "container/unordered_map.hpp"
+#include <cstdio>
+#include <filesystem>
+
+TEST(HashImageTest, trivial) {
+    std::string path = (std::filesystem::temp_directory_path() / "anya_hash_image_trivial.bin").string();
+    anya::unordered_map<int, double> map;
+    for (int i = 0; i < 10000; ++i) map.emplace(i * 7, i * 0.5);
+    anya::write_hash_image(map, path.c_str());
+
+    anya::hash_image_view<int, double> view(path.c_str());
+    EXPECT_TRUE(view.size() == 10000);
+    EXPECT_TRUE(view.bucket_count() >= view.size());
+    for (int i = 0; i < 10000; ++i) {
+        auto result = view.find(i * 7);
+        EXPECT_TRUE(result && *result == i * 0.5);
+    }
+    EXPECT_FALSE(view.find(1));
+    EXPECT_FALSE(view.contains(-7));
+    size_t visited = 0;
+    view.for_each([&](int key, double value) { visited += map.at(key) == value; });
+    EXPECT_TRUE(visited == 10000);
+
+    // 视图可以移动，映射的页面随之转移
+    auto other = std::move(view);
+    EXPECT_TRUE(other.contains(7) && other.size() == 10000);
+    std::remove(path.c_str());
+}
+
+TEST(HashImageTest, string) {
+    std::string path = (std::filesystem::temp_directory_path() / "anya_hash_image_string.bin").string();
+    anya::unordered_map<std::string, std::string> map;
+    for (int i = 0; i < 1000; ++i) map.emplace(std::to_string(i), std::string(i % 50, 'a'));
+    map.emplace("", "empty");
+    anya::write_hash_image(map, path.c_str());
+
+    anya::hash_image_view<std::string, std::string> view(path.c_str());
+    EXPECT_TRUE(view.size() == 1001);
+    for (int i = 0; i < 1000; ++i) EXPECT_TRUE(view.find(std::to_string(i)) == std::string(i % 50, 'a'));
+    EXPECT_TRUE(view.find("") == "empty");
+    EXPECT_FALSE(view.find("anya"));
+
+    anya::unordered_map<std::string, int> empty;
+    anya::write_hash_image(empty, path.c_str());
+    anya::hash_image_view<std::string, int> empty_view(path.c_str());
+    EXPECT_TRUE(empty_view.empty() && !empty_view.contains("0"));
+    std::remove(path.c_str());
+}
+
+TEST(HashImageTest, reject) {
+    std::string path = (std::filesystem::temp_directory_path() / "anya_hash_image_reject.bin").string();
+    anya::unordered_map<long, long> map;
+    for (long i = 0; i < 1000; ++i) map.emplace(i, -i);
+    anya::write_hash_image(map, path.c_str());
+
+    // 类型不一致
+    EXPECT_THROW((anya::hash_image_view<int, long>(path.c_str())), anya::hash_image_error);
+    EXPECT_THROW((anya::hash_image_view<long, std::string>(path.c_str())), anya::hash_image_error);
+
+    auto patch = [&](long offset, const void* data, size_t n) {
+        std::FILE* file = std::fopen(path.c_str(), "r+b");
+        std::fseek(file, offset, SEEK_SET);
+        std::fwrite(data, 1, n, file);
+        std::fclose(file);
+    };
+    // 改动一个值：不校验时照常打开，校验时发现校验和不一致
+    long value = 12345;
+    patch(long(sizeof(anya::hash_image_header)) + 4096, &value, sizeof(value));
+    EXPECT_NO_THROW((anya::hash_image_view<long, long>(path.c_str(), false)));
+    EXPECT_THROW((anya::hash_image_view<long, long>(path.c_str())), anya::hash_image_error);
+    // 版本号不一致
+    uint32_t version = anya::hash_image_header::current_version + 1;
+    patch(offsetof(anya::hash_image_header, version), &version, sizeof(version));
+    EXPECT_THROW((anya::hash_image_view<long, long>(path.c_str(), false)), anya::hash_image_error);
+    std::remove(path.c_str());
+    EXPECT_THROW((anya::hash_image_view<long, long>(path.c_str())), anya::hash_image_error);
+}
+
+#endif //ANYA_STL_HASH_IMAGE_TEST_HPP
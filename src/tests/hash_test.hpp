@@ -0,0 +1,124 @@
+//
+// Created by Anya on 2023/8/20.
+//
+
+#ifndef ANYA_STL_HASH_TEST_HPP
+#define ANYA_STL_HASH_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "functional/hash.hpp"
+#include "container/unordered_map.hpp"
+#include "container/unordered_set.hpp"
+#include <random>
+#include <set>
+
+TEST(HashTest, integer) {
+    anya::hash<int> hash;
+    EXPECT_TRUE(hash(0) != 0 && hash(1) != 1);
+    // 步长为2的幂的key，低位和高位都要分散开
+    std::set<size_t> low, high;
+    for (int i = 0; i < 4096; ++i) low.insert(hash(i << 12) & 4095), high.insert(hash(i << 12) >> 52);
+    EXPECT_TRUE(low.size() > 2000 && high.size() > 2000);
+
+    enum class color : short { red, green };
+    EXPECT_TRUE(anya::hash<color>{}(color::green) == anya::hash<short>{}(1));
+    EXPECT_TRUE(anya::hash<double>{}(0.0) == anya::hash<double>{}(-0.0));
+    EXPECT_TRUE(anya::hash<float>{}(1.0f) != anya::hash<float>{}(2.0f));
+    int x = 0;
+    EXPECT_TRUE(anya::hash<int*>{}(&x) == anya::hash<uintptr_t>{}(reinterpret_cast<uintptr_t>(&x)));
+    EXPECT_TRUE(anya::is_fast_hash<anya::hash<long>>::value);
+    EXPECT_FALSE(anya::is_fast_hash<anya::hash<std::string>>::value);
+}
+
+TEST(HashTest, string) {
+    anya::hash<std::string> hash;
+    EXPECT_TRUE(hash("anya") == hash(std::string("anya")));
+    EXPECT_TRUE(hash("anya") == anya::hash<std::string_view>{}("anya"));
+    EXPECT_TRUE(hash("anya") == anya::string_hash{}("anya"));
+
+    // 各个长度分支的边界上，改动任何一个字节都要改变哈希值
+    std::mt19937_64 engine(7);
+    std::string data(2000, '\0');
+    for (auto& c : data) c = char(engine());
+    std::set<size_t> seen;
+    for (size_t len : {0, 1, 2, 3, 4, 7, 8, 15, 16, 17, 48, 49, 64, 100, 511, 512, 513, 1024, 1025, 2000}) {
+        std::string str = data.substr(0, len);
+        EXPECT_TRUE(seen.insert(hash(str)).second);
+        for (size_t i = 0; i < len; i += 1 + len / 16) {
+            std::string other = str;
+            other[i] ^= 1;
+            EXPECT_TRUE(hash(other) != hash(str));
+        }
+    }
+
+    // SIMD 与标量的长串实现结果一致
+    auto bytes = reinterpret_cast<const unsigned char*>(data.data());
+    for (size_t len : {64, 65, 512, 1024, 1088, 2000}) {
+        uint64_t expected = anya::hash_bulk::hash_scalar(bytes, len, 0);
+        EXPECT_TRUE(anya::hash_bulk::hash(bytes, len, 0) == expected);
+#if defined(__SSE2__)
+        EXPECT_TRUE(anya::hash_bulk::hash_sse2(bytes, len, 0) == expected);
+#endif
+#if defined(ANYA_HASH_AVX2_DISPATCH)
+        if (anya::hash_bulk::has_avx2()) {
+            EXPECT_TRUE(anya::hash_bulk::hash_avx2(bytes, len, 0) == expected);
+        }
+#endif
+    }
+}
+
+struct hash_point {
+    int x, y;
+
+    bool operator==(const hash_point&) const = default;
+};
+
+struct hash_custom {
+    int value;
+
+    bool operator==(const hash_custom&) const = default;
+};
+
+template<>
+struct std::hash<hash_custom> {
+    size_t
+    operator()(const hash_custom& c) const noexcept { return c.value; }
+};
+
+TEST(HashTest, compound) {
+    using pair = std::pair<int, std::string>;
+    anya::hash<pair> pair_hash;
+    EXPECT_TRUE(pair_hash({1, "anya"}) == anya::hash_values(1, std::string("anya")));
+    EXPECT_TRUE(pair_hash({1, "anya"}) != pair_hash({2, "anya"}));
+    anya::hash<std::pair<int, int>> int_pair_hash;
+    EXPECT_TRUE(int_pair_hash({1, 2}) != int_pair_hash({2, 1}));
+    anya::hash<std::tuple<int, long, std::string>> tuple_hash;
+    EXPECT_TRUE(tuple_hash({1, 2, "3"}) == anya::hash_values(1, 2L, std::string("3")));
+
+    // 没有填充字节的聚合体按字节哈希；特化了 std::hash 的类型仍使用 std::hash
+    EXPECT_TRUE(anya::hash<hash_point>{}({1, 2}) != anya::hash<hash_point>{}({2, 1}));
+    EXPECT_TRUE(anya::hash<hash_custom>{}({42}) == 42);
+
+    anya::unordered_map<std::pair<int, int>, int> grid;
+    for (int i = 0; i < 100; ++i) grid.emplace(std::pair(i / 10, i % 10), i);
+    EXPECT_TRUE(grid.at({3, 4}) == 34);
+    anya::unordered_set<hash_point> points{{1, 2}, {2, 1}, {1, 2}};
+    EXPECT_TRUE(points.size() == 2);
+}
+
+TEST(HashTest, distribution) {
+    // 质数桶下恒等哈希遇到桶数整数倍的key会全部落进同一个桶
+    using prime_table = anya::hashtable<long, long, std::hash<long>, std::equal_to<long>,
+                                        anya::allocator<std::pair<const long, long>>, anya::prime_rehash_policy>;
+    using mixed_table = anya::hashtable<long, long, anya::hash<long>, std::equal_to<long>,
+                                        anya::allocator<std::pair<const long, long>>, anya::prime_rehash_policy>;
+    prime_table identity(20000);
+    mixed_table mixed(20000);
+    long buckets = long(identity.bucket_count());
+    for (long i = 0; i < 1000; ++i) identity.emplace_unique(i * buckets, i), mixed.emplace_unique(i * buckets, i);
+    EXPECT_TRUE(identity.statistics().longest_chain == 1000);
+    EXPECT_TRUE(mixed.statistics().longest_chain < 8);
+}
+
+#endif //ANYA_STL_HASH_TEST_HPP
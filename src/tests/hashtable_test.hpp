@@ -186,4 +186,301 @@ TEST(HashTableTest, hash_policy) {
     EXPECT_TRUE(anya1.bucket_count() == anya2.bucket_count());
     EXPECT_TRUE(anya1.size() == anya2.size());
 }
+
+TEST(HashTableTest, rehash_policy) {
+    {
+        anya::hashtable<int, int> anya;
+        for (int i = 0; i < 1000; ++i) anya.emplace_unique(i * 1024, i);
+        EXPECT_TRUE(std::has_single_bit(anya.bucket_count()));
+        for (int i = 0; i < 1000; ++i) EXPECT_TRUE(anya.find(i * 1024)->second == i);
+        EXPECT_TRUE(anya.count(7) == 0);
+    }
+
+    {
+        anya::hashtable<int, int, std::hash<int>, std::equal_to<int>,
+                        anya::allocator<std::pair<const int, int>>, anya::prime_rehash_policy> anya;
+        for (int i = 0; i < 1000; ++i) anya.emplace_unique(i * 1024, i);
+        EXPECT_TRUE(anya.bucket_count() == 1543);
+        EXPECT_TRUE(anya.max_bucket_count() == anya::prime_rehash_policy::max_bucket_count());
+        for (int i = 0; i < 1000; ++i) EXPECT_TRUE(anya.find(i * 1024)->second == i);
+        EXPECT_TRUE(anya.count(7) == 0);
+    }
+}
+
+TEST(HashTableTest, traverse) {
+    anya::hashtable<int, int> anya;
+    std::unordered_multimap<int, int> std, temp;
+    for (int i = 0; i < 1000; ++i) anya.emplace_multi(i % 300, i), std.insert({i % 300, i});
+    for (auto& kv : anya) temp.insert(kv);
+    EXPECT_TRUE(std == temp);
+
+    // 每个等值区间都必须恰好覆盖同一个key的全部元素
+    for (int key = 0; key < 300; ++key) {
+        auto [first, last] = anya.equal_range(key);
+        EXPECT_TRUE(size_t(anya::distance(first, last)) == anya.count(key));
+        for (; first != last; ++first) EXPECT_TRUE(first->first == key);
+    }
+
+    // 删除中间的一段后，剩余元素仍能完整遍历
+    auto first = anya.begin(), last = anya.begin();
+    anya::advance(first, 100), anya::advance(last, 600);
+    for (auto it = first; it != last; ++it) std.erase(std.find(it->first));
+    anya.erase(first, last);
+    EXPECT_TRUE(anya.size() == 500);
+    EXPECT_TRUE(anya::distance(anya.begin(), anya.end()) == 500);
+    for (int key = 0; key < 300; ++key) EXPECT_TRUE(anya.count(key) == std.count(key));
+
+    // 不断删除begin()直到为空
+    while (!anya.empty()) anya.erase(anya.begin());
+    EXPECT_TRUE(anya.begin() == anya.end());
+}
+
+// 记录调用次数的哈希函数
+struct counting_hash {
+    inline static size_t calls = 0;
+
+    size_t
+    operator()(const std::string& key) const { return ++calls, std::hash<std::string>{}(key); }
+};
+
+TEST(HashTableTest, cached_hash_code) {
+    anya::hashtable<std::string, int, counting_hash> anya;
+    for (int i = 0; i < 1000; ++i) anya.emplace_unique(std::to_string(i), i);
+    // 缓存了哈希值，rehash 时不再调用哈希函数
+    size_t calls = counting_hash::calls;
+    anya.rehash(100000);
+    EXPECT_TRUE(counting_hash::calls == calls);
+    for (int i = 0; i < 1000; ++i) EXPECT_TRUE(anya.find(std::to_string(i))->second == i);
+    EXPECT_TRUE(anya.count("anya") == 0);
+
+    auto copy = anya;
+    EXPECT_TRUE(copy == anya);
+    anya.erase("0");
+    EXPECT_TRUE(copy != anya);
+}
+
+TEST(HashTableTest, incremental_rehash) {
+    anya::hashtable<int, int> anya;
+    std::unordered_multimap<int, int> std, temp;
+    anya.incremental_rehash(1);
+    bool migrated = false;
+    for (int i = 0; i < 5000; ++i) {
+        anya.emplace_multi(i % 1500, i), std.insert({i % 1500, i});
+        if (!anya.rehashing()) continue;
+        migrated = true;
+        // 迁移途中查找、计数和遍历都必须同时覆盖新旧两个桶数组
+        EXPECT_TRUE(anya.find(i % 1500)->first == i % 1500);
+        EXPECT_TRUE(anya.count(i % 1500) == std.count(i % 1500));
+        EXPECT_TRUE(size_t(anya::distance(anya.begin(), anya.end())) == anya.size());
+    }
+    EXPECT_TRUE(migrated);
+    for (auto& kv : anya) temp.insert(kv);
+    EXPECT_TRUE(std == temp);
+
+    // 迁移途中拷贝、按key删除、按迭代器删除
+    while (!anya.rehashing()) anya.emplace_multi(anya.size(), 0), std.insert({std.size(), 0});
+    auto copy = anya;
+    EXPECT_TRUE(copy == anya);
+    for (int key = 0; key < 1500; key += 2) EXPECT_TRUE(anya.erase(key) == std.erase(key));
+    for (int key = 0; key < 1500; ++key) {
+        auto [first, last] = anya.equal_range(key);
+        EXPECT_TRUE(size_t(anya::distance(first, last)) == std.count(key));
+    }
+    while (!anya.empty()) anya.erase(anya.begin());
+    EXPECT_TRUE(anya.rehashing() && anya.begin() == anya.end());
+
+    // 关闭渐进式rehash时立即迁移完
+    copy.incremental_rehash(0);
+    EXPECT_FALSE(copy.rehashing());
+    EXPECT_TRUE(size_t(anya::distance(copy.begin(), copy.end())) == copy.size());
+    for (int key = 0; key < 1500; ++key) EXPECT_TRUE(copy.count(key) > 0);
+}
+
+TEST(HashTableTest, node_handle) {
+    anya::hashtable<int, int> lhs, rhs;
+    for (int i = 0; i < 100; ++i) lhs.emplace_multi(i % 10, i), rhs.emplace_multi(i % 20, i);
+    auto node = rhs.extract(rhs.find(15));
+    EXPECT_TRUE(node.key() == 15 && rhs.count(15) == 4);
+    lhs.insert_multi(std::move(node));
+    EXPECT_TRUE(lhs.count(15) == 1);
+    lhs.merge_multi(rhs);
+    EXPECT_TRUE(rhs.empty() && rhs.begin() == rhs.end());
+    EXPECT_TRUE(lhs.size() == 200);
+    EXPECT_TRUE(lhs.count(5) == 15 && lhs.count(15) == 5);
+    auto [first, last] = lhs.equal_range(5);
+    EXPECT_TRUE(anya::distance(first, last) == 15);
+}
+
+// 只有8种哈希值的哈希函数，为它单独打开运行计数
+struct clustered_hash {
+    size_t
+    operator()(int key) const { return key % 8; }
+};
+
+template<>
+struct anya::hash_stats_enabled<clustered_hash> : std::true_type {};
+
+TEST(HashTableTest, statistics) {
+    anya::hashtable<int, int> good;
+    for (int i = 0; i < 1000; ++i) good.emplace_unique(i, i);
+    auto stats = good.statistics(4);
+    EXPECT_TRUE(stats.size == 1000 && stats.bucket_count == good.bucket_count());
+    EXPECT_TRUE(stats.load_factor == good.load_factor() && stats.load_factor < 1);
+    EXPECT_TRUE(stats.histogram.size() == 5);
+    size_t buckets = 0, elements = 0;
+    for (size_t i = 0; i < stats.histogram.size(); ++i) buckets += stats.histogram[i], elements += i * stats.histogram[i];
+    EXPECT_TRUE(buckets == stats.bucket_count && stats.histogram[0] == stats.empty_buckets);
+    EXPECT_TRUE(stats.longest_chain >= 4 || elements == 1000);
+    // 默认不计数
+    good.find(1);
+    EXPECT_TRUE(good.counters().lookups == 0);
+    // 被移动后的表没有桶，两个比例都为0
+    anya::hashtable<int, int> moved(std::move(good));
+    stats = good.statistics();
+    EXPECT_TRUE(stats.bucket_count == 0 && stats.load_factor == 0 && stats.empty_ratio == 0);
+
+    anya::hashtable<int, int, clustered_hash> bad;
+    for (int i = 0; i < 1000; ++i) bad.emplace_unique(i, i);
+    stats = bad.statistics();
+    EXPECT_TRUE(stats.longest_chain == 125);
+    EXPECT_TRUE(stats.bucket_count - stats.empty_buckets <= 8);
+    EXPECT_TRUE(stats.histogram.back() == stats.bucket_count - stats.empty_buckets);
+    EXPECT_TRUE(stats.empty_ratio > 0.9f);
+    auto counters = bad.counters();
+    EXPECT_TRUE(counters.lookups == 1000 && counters.rehashes > 0);
+    EXPECT_TRUE(counters.probes > 1000 * 50);
+
+    bad.reset_counters();
+    EXPECT_TRUE(bad.find(999) != bad.end());
+    EXPECT_TRUE(bad.counters().lookups == 1 && bad.counters().probes >= 1);
+    bad.incremental_rehash(1);
+    bad.rehash(100000);
+    EXPECT_TRUE(bad.counters().rehashes == 1 && bad.counters().rehash_nanos > 0);
+}
+
+TEST(HashTableTest, shrink) {
+    anya::hashtable<int, int> anya;
+    for (int i = 0; i < 100000; ++i) anya.emplace_unique(i, i);
+    size_t peak = anya.bucket_count();
+    // 按key删除到装载因子低于下限后，下一次插入时才缩小，缩小后装载因子不超过上限的一半
+    // 删除期间桶数组不变，指向其他元素的迭代器保持有效
+    auto kept = anya.find(99999);
+    for (int i = 0; i < 99000; ++i) anya.erase(i);
+    EXPECT_TRUE(anya.bucket_count() == peak && kept->second == 99999);
+    anya.erase(kept);
+    anya.emplace_unique(99999, 99999);
+    EXPECT_TRUE(anya.bucket_count() < peak / 8);
+    EXPECT_TRUE(anya.load_factor() >= anya.min_load_factor() && anya.load_factor() <= anya.max_load_factor() / 2);
+    for (int i = 99000; i < 100000; ++i) EXPECT_TRUE(anya.find(i)->second == i);
+    // 在阈值附近交替插入删除不会反复rehash
+    size_t buckets = anya.bucket_count();
+    for (int i = 0; i < 100; ++i) anya.emplace_unique(-1, 0), anya.erase(-1);
+    EXPECT_TRUE(anya.bucket_count() == buckets);
+
+    // 用迭代器删除时其他迭代器保持有效，下一次插入时才缩小
+    for (auto it = anya.begin(); it != anya.end();) {
+        if (it->first % 10) it = anya.erase(it);
+        else ++it;
+    }
+    EXPECT_TRUE(anya.size() == 100 && anya.bucket_count() == buckets);
+    anya.emplace_unique(-1, -1);
+    EXPECT_TRUE(anya.bucket_count() < buckets);
+    size_t visited = 0;
+    for (auto it = anya.begin(); it != anya.end(); ++it) ++visited;
+    EXPECT_TRUE(visited == 101);
+
+    // 预留的桶不会因为元素少而被插入缩小
+    anya::hashtable<int, int> reserved;
+    reserved.reserve(10000);
+    buckets = reserved.bucket_count();
+    for (int i = 0; i < 10; ++i) reserved.emplace_unique(i, i);
+    EXPECT_TRUE(reserved.bucket_count() == buckets);
+    reserved.reserve(10);
+    EXPECT_TRUE(reserved.bucket_count() == buckets);
+
+    // shrink_to_fit 和 rehash 可以缩小到刚好容纳现有元素
+    reserved.shrink_to_fit();
+    EXPECT_TRUE(reserved.bucket_count() == anya::power2_rehash_policy::min_bucket_count);
+    reserved.rehash(1000);
+    EXPECT_TRUE(reserved.bucket_count() == 1024);
+    for (int i = 0; i < 10; ++i) EXPECT_TRUE(reserved.find(i)->second == i);
+
+    anya::hashtable<int, int> fixed;
+    fixed.min_load_factor(0);
+    for (int i = 0; i < 1000; ++i) fixed.emplace_unique(i, i);
+    buckets = fixed.bucket_count();
+    for (int i = 0; i < 1000; ++i) fixed.erase(i);
+    EXPECT_TRUE(fixed.empty() && fixed.bucket_count() == buckets);
+}
+
+TEST(HashTableTest, parallel) {
+    // 输入中有重复的key，值不同，不重复插入时保留先出现的
+    anya::vector<std::pair<int, int>> input;
+    for (int i = 0; i < 200000; ++i) input.push_back({i % 150000, i});
+    anya::hashtable<int, int> sequential, parallel;
+    for (auto& value : input) sequential.emplace_unique(value);
+    parallel.emplace_unique(-1, -1);
+    EXPECT_TRUE(parallel.insert_parallel_unique(input.begin(), input.end(), 4) == 150000);
+    EXPECT_TRUE(parallel.size() == 150001);
+    for (auto& [key, value] : sequential) EXPECT_TRUE(parallel.find(key)->second == value);
+    size_t visited = 0;
+    for (auto it = parallel.begin(); it != parallel.end(); ++it) ++visited;
+    EXPECT_TRUE(visited == parallel.size());
+
+    // 可重复插入时相同的key相邻
+    anya::hashtable<int, int> multi;
+    EXPECT_TRUE(multi.insert_parallel_multi(input.begin(), input.end(), 4) == 200000);
+    EXPECT_TRUE(multi.size() == 200000 && multi.count(1) == 2 && multi.count(149999) == 1);
+    int previous = -1;
+    size_t groups = 0;
+    for (auto it = multi.begin(); it != multi.end(); ++it) {
+        if (it->first != previous) ++groups, previous = it->first;
+    }
+    EXPECT_TRUE(groups == 150000);
+
+    // 并行rehash前后元素不变
+    parallel.rehash(parallel.bucket_count() * 4, 4);
+    EXPECT_TRUE(parallel.size() == 150001 && parallel.find(-1)->second == -1);
+    for (auto& [key, value] : sequential) EXPECT_TRUE(parallel.find(key)->second == value);
+    parallel.reserve(1000000, 4);
+    EXPECT_TRUE(parallel.bucket_count() * parallel.max_load_factor() >= 1000000);
+    visited = 0;
+    for (auto it = parallel.begin(); it != parallel.end(); ++it) ++visited;
+    EXPECT_TRUE(visited == parallel.size());
+
+    // 使用单独的线程池，threads 为0时取线程池的大小
+    anya::thread_pool pool(3);
+    anya::hashtable<int, int> isolated;
+    EXPECT_TRUE(isolated.insert_parallel_unique(input.begin(), input.end(), 0, pool) == 150000);
+    isolated.rehash(isolated.bucket_count() * 2, 0, pool);
+    for (auto& [key, value] : sequential) EXPECT_TRUE(isolated.find(key)->second == value);
+}
+
+TEST(HashTableTest, erase_if) {
+    anya::hashtable<int, int> anya;
+    anya.incremental_rehash(4);
+    int i = 0;
+    while (!anya.rehashing() || anya.size() < 3000) anya.emplace_multi(i, i), anya.emplace_multi(i, -i - 1), ++i;
+    size_t odd = 0;
+    for (auto& [key, value] : anya) odd += key % 2;
+    // 渐进式rehash进行中，新旧桶数组里的结点都要检查
+    EXPECT_TRUE(anya.rehashing());
+    EXPECT_EQ(anya.erase_if([](const auto& kv) { return kv.first % 2 == 1; }), odd);
+    EXPECT_EQ(size_t(anya::distance(anya.begin(), anya.end())), anya.size());
+    for (auto& [key, value] : anya) EXPECT_TRUE(key % 2 == 0);
+    EXPECT_TRUE(anya.count(2) == 2 && anya.count(3) == 0);
+    size_t negative = anya.size() / 2;
+    EXPECT_EQ(anya.erase_if([](const auto& kv) { return kv.second < 0; }), negative);
+    EXPECT_TRUE(anya.count(2) == 1 && anya.find(2)->second == 2);
+    // 删到欠载时桶数组不变，指向剩下元素的迭代器保持有效，下一次插入时才缩小
+    anya.incremental_rehash(0);
+    size_t buckets = anya.bucket_count();
+    size_t others = anya.size() - 1;
+    auto kept = anya.find(0);
+    EXPECT_EQ(anya.erase_if([](const auto& kv) { return kv.first != 0; }), others);
+    EXPECT_TRUE(anya.bucket_count() == buckets && kept->second == 0);
+    anya.emplace_multi(1, 1);
+    EXPECT_TRUE(anya.bucket_count() < buckets);
+}
+
 #endif //ANYA_STL_HASHTABLE_TEST_HPP
@@ -5,10 +5,12 @@
 #include "iterator/iterator.hpp"
 #include "iterator/iterator_concept.hpp"
 #include "allocator/memory.hpp"
+#include "container/list.hpp"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include <iterator>
 #include <list>
+#include <string>
 
 TEST(IterTest, address) {
     std::vector<int> anya(110, 0);
@@ -36,4 +38,12 @@ TEST(IterTest, reverse_iterator) {
     for (int i = 5; i >= 0; --i, ++rit2) {
         EXPECT_TRUE(*rit2 == arr[i]);
     }
-}
\ No newline at end of file
+}
+
+TEST(IterTest, next_prev) {
+    // 元素类型在 std 中时，ADL也能找到 std::advance，next/prev 内部必须调用 anya::advance
+    anya::list<std::string> names{"anya", "yor", "loid"};
+    EXPECT_TRUE(*anya::next(names.begin()) == "yor");
+    EXPECT_TRUE(*anya::prev(names.end(), 2) == "yor");
+    EXPECT_TRUE(anya::next(names.begin(), 3) == names.end());
+}
@@ -9,6 +9,7 @@
 #include "gmock/gmock.h"
 #include "container/list.hpp"
 #include "container/vector.hpp"
+#include "allocator/node_slab.hpp"
 #include <list>
 
 TEST(ListTest, construct) {
@@ -279,6 +280,17 @@ TEST(ListTest, merge) {
         anya2.merge(anya3, std::greater<>());
         EXPECT_TRUE(anya2 == anya1);
     }
+
+    {
+        // merge 与 clear 之后哨兵的前驱指回根结点，继续插入不会经过已释放的结点
+        anya::list<int> anya1{1, 4};
+        anya::list<int> anya2{1, 5};
+        anya1.merge(anya2);
+        anya2.push_back(9);
+        anya1.clear();
+        anya1.push_back(8);
+        EXPECT_TRUE(anya1 == (anya::list<int>{8}) && anya2 == (anya::list<int>{9}));
+    }
 }
 
 TEST(ListTest, splice) {
@@ -383,4 +395,77 @@ TEST(ListTest, compare) {
     EXPECT_TRUE(std_anya != std_mnzn);
 }
 
+TEST(ListTest, slab) {
+    using slab_list = anya::list<std::string, anya::slab_allocator<std::string>>;
+    slab_list anya;
+    for (int i = 0; i < 1000; ++i) anya.push_back(std::to_string(i));
+    EXPECT_TRUE(anya.size() == 1000 && anya.front() == "0" && anya.back() == "999");
+    anya.remove_if([](const std::string& s) { return s.size() < 3; });
+    EXPECT_TRUE(anya.size() == 900 && anya.front() == "100");
+
+    // clear 后结点池整块归还，可以继续使用
+    anya.clear();
+    EXPECT_TRUE(anya.empty() && anya.begin() == anya.end());
+    anya.push_back("anya");
+    anya.push_front("yor");
+    EXPECT_TRUE(anya == (slab_list{"yor", "anya"}));
+
+    // merge 接管另一个链表的结点池
+    slab_list other{"bond", "loid"};
+    anya.sort(), other.sort();
+    anya.merge(other);
+    EXPECT_TRUE(other.empty() && anya == (slab_list{"anya", "bond", "loid", "yor"}));
+    other.push_back("neko");
+    EXPECT_TRUE(other.size() == 1 && other.front() == "neko");
+
+    // 移动与交换时结点池跟着结点走
+    slab_list moved(std::move(anya));
+    EXPECT_TRUE(anya.empty() && moved.size() == 4);
+    anya = std::move(other);
+    EXPECT_TRUE(anya == (slab_list{"neko"}) && other.empty());
+    anya.swap(moved);
+    EXPECT_TRUE(anya.size() == 4 && moved.front() == "neko");
+    slab_list copy(anya);
+    anya.clear();
+    EXPECT_TRUE(copy == (slab_list{"anya", "bond", "loid", "yor"}));
+
+    anya::list<int, anya::slab_allocator<int>> numbers(100000, 1);
+    numbers.clear();
+    numbers.assign({1, 2, 3});
+    EXPECT_TRUE(numbers.size() == 3 && numbers.back() == 3);
+}
+
+TEST(ListTest, erase_if) {
+    anya::list<int> anya{8, 7, 5, 9, 0, 1, 3, 2, 6, 4};
+    EXPECT_EQ(anya::erase_if(anya, [](int x) { return x % 2 == 0; }), 5u);
+    EXPECT_TRUE(anya == (anya::list<int>{7, 5, 9, 1, 3}));
+}
+
+TEST(ListTest, splice_relink) {
+    // 跨链表与同一链表内的 splice 都只修改指针，元素地址不变
+    anya::list<std::string> anya{"a", "n", "y", "a"};
+    anya::list<std::string> mnzn{"m", "n", "z", "n"};
+    const std::string* z = &*anya::next(mnzn.begin(), 2);
+    anya.splice(anya.begin(), mnzn, anya::next(mnzn.begin()), anya::prev(mnzn.end()));
+    EXPECT_TRUE(anya == (anya::list<std::string>{"n", "z", "a", "n", "y", "a"}));
+    EXPECT_TRUE(mnzn == (anya::list<std::string>{"m", "n"}) && mnzn.size() == 2);
+    EXPECT_TRUE(&*anya::next(anya.begin()) == z);
+
+    anya.splice(anya.begin(), anya, anya::prev(anya.end()), anya.end());
+    anya.splice(anya.end(), anya, anya::next(anya.begin()), anya::next(anya.begin(), 3));
+    EXPECT_TRUE(anya == (anya::list<std::string>{"a", "a", "n", "y", "n", "z"}) && anya.size() == 6);
+    EXPECT_TRUE(&anya.back() == z);
+
+    // 使用结点池时，部分移动逐个移动元素，整个链表移动时接管结点池
+    using slab_list = anya::list<std::string, anya::slab_allocator<std::string>>;
+    slab_list yor{"y", "o", "r"}, loid{"l", "o", "i", "d"};
+    yor.splice(yor.end(), loid, loid.begin(), anya::next(loid.begin(), 2));
+    EXPECT_TRUE(yor == (slab_list{"y", "o", "r", "l", "o"}) && loid == (slab_list{"i", "d"}));
+    yor.splice(yor.begin(), loid);
+    EXPECT_TRUE(yor == (slab_list{"i", "d", "y", "o", "r", "l", "o"}) && loid.empty());
+    loid.push_back("bond");
+    yor.clear();
+    EXPECT_TRUE(loid.size() == 1 && loid.front() == "bond");
+}
+
 #endif //ANYA_STL_LIST_TEST_HPP
@@ -8,6 +8,7 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "expand/lru.hpp"
+#include "functional/hash.hpp"
 
 TEST(LRUTest, all) {
     anya::lru_cache<std::string, int> lru;
@@ -25,4 +26,45 @@ TEST(LRUTest, all) {
     EXPECT_TRUE(lru.contains("anya"));
 }
 
+TEST(LRUTest, transparent) {
+    anya::lru_cache<std::string, int, anya::string_hash, std::equal_to<>> lru(2);
+    lru.push("anya", 0);
+    lru.push("mnzn", 1);
+    std::string_view view = "anya";
+    EXPECT_TRUE(lru.contains(view));
+    EXPECT_TRUE(lru.get_or_default(view) == 0);
+    lru.push("neko", 2);
+    EXPECT_FALSE(lru.contains(std::string_view("mnzn")));
+    lru.erase(view);
+    EXPECT_FALSE(lru.contains(view));
+}
+
+TEST(LRUTest, get) {
+    anya::lru_cache<std::string, std::string> lru(3);
+    lru.push("anya", "peanut");
+    lru.push("loid", "coffee");
+    lru.push("yor", "knife");
+    EXPECT_TRUE(lru.get("bond") == nullptr);
+
+    // 命中时返回的指针指向缓存中的值，提升到队头后地址不变
+    std::string* value = lru.get("anya");
+    ASSERT_TRUE(value != nullptr);
+    EXPECT_TRUE(*value == "peanut");
+    EXPECT_TRUE(lru.get("anya") == value);
+    *value = "chocolate";
+    EXPECT_TRUE(lru.get_or_default("anya") == "chocolate");
+
+    // anya 被提升过，淘汰的是最久没有访问的 loid
+    lru.push("bond", "bone");
+    EXPECT_FALSE(lru.contains("loid"));
+    EXPECT_TRUE(lru.contains("anya") && lru.contains("yor") && lru.contains("bond"));
+
+    // 更新已有的key同样原地修改并提升
+    lru.push("yor", "needle");
+    EXPECT_TRUE(lru.get("anya") == value);
+    lru.push("neko", "fish");
+    EXPECT_FALSE(lru.contains("bond"));
+    EXPECT_TRUE(*lru.get("yor") == "needle");
+}
+
 #endif //ANYA_STL_LRU_TEST_HPP
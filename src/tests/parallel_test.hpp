@@ -0,0 +1,100 @@
+//
+// Created by Anya on 2023/8/25.
+//
+
+#ifndef ANYA_STL_PARALLEL_TEST_HPP
+#define ANYA_STL_PARALLEL_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "thread/parallel_algorithm.hpp"
+#include "container/unordered_map.hpp"
+#include "container/unordered_set.hpp"
+#include <atomic>
+#include <stdexcept>
+
+TEST(ParallelTest, thread_pool) {
+    anya::thread_pool pool(4);
+    EXPECT_TRUE(pool.size() == 4);
+    // 每个任务恰好执行一次，可以反复使用
+    for (int round = 0; round < 10; ++round) {
+        anya::vector<int> hits(1000, 0);
+        pool.run(hits.size(), [&](size_t i) { ++hits[i]; });
+        for (int hit : hits) EXPECT_TRUE(hit == 1);
+    }
+    // 任务中再调用 run 不会死锁
+    std::atomic<int> total{0};
+    pool.run(8, [&](size_t) { pool.run(8, [&](size_t) { ++total; }); });
+    EXPECT_TRUE(total == 64);
+    // 其余任务照常执行，结束后抛出异常
+    total = 0;
+    EXPECT_THROW(pool.run(100, [&](size_t i) {
+        ++total;
+        if (i == 42) throw std::runtime_error("task");
+    }), std::runtime_error);
+    EXPECT_TRUE(total == 100);
+}
+
+TEST(ParallelTest, split) {
+    anya::unordered_map<int, int> map;
+    EXPECT_TRUE(map.split(8).empty());
+    for (int i = 0; i < 10000; ++i) map.emplace(i, i);
+    // 各段首尾相接，合起来正好是整个表
+    for (size_t parts : {1, 3, 8, 64, 1000000}) {
+        auto ranges = map.split(parts);
+        EXPECT_TRUE(!ranges.empty() && ranges.size() <= parts);
+        EXPECT_TRUE(ranges.front().first == map.begin() && ranges.back().second == map.end());
+        size_t visited = 0;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            if (i > 0) {
+                EXPECT_TRUE(ranges[i - 1].second == ranges[i].first);
+            }
+            EXPECT_TRUE(ranges[i].first != ranges[i].second);
+            for (auto it = ranges[i].first; it != ranges[i].second; ++it) ++visited;
+        }
+        EXPECT_TRUE(visited == map.size());
+    }
+
+    // 渐进式rehash途中切分同时覆盖新旧两个桶数组
+    anya::hashtable<int, int> table;
+    table.incremental_rehash(1);
+    for (int i = 0; !table.rehashing() || i < 100; ++i) table.emplace_unique(i, i);
+    size_t visited = 0;
+    for (auto& [from, to] : table.split(16)) {
+        for (auto it = from; it != to; ++it) ++visited;
+    }
+    EXPECT_TRUE(table.rehashing() && visited == table.size());
+}
+
+TEST(ParallelTest, for_each_and_reduce) {
+    anya::thread_pool pool(4);
+    anya::unordered_map<int, long long> map;
+    for (int i = 1; i <= 100000; ++i) map.emplace(i, i);
+    anya::parallel_for_each(map, [](auto& value) { value.second *= 2; }, pool);
+    auto sum = anya::parallel_reduce(map, 0LL, std::plus<>(), [](auto& value) { return value.second; }, pool);
+    EXPECT_TRUE(sum == 100000LL * 100001);
+
+    // 集合与默认线程池
+    anya::unordered_set<int> set;
+    for (int i = 0; i < 1000; ++i) set.emplace(i);
+    EXPECT_TRUE(anya::parallel_reduce(set, 0) == 999 * 1000 / 2);
+    auto largest = anya::parallel_reduce(set, -1, [](int a, int b) { return anya::max(a, b); });
+    EXPECT_TRUE(largest == 999);
+    std::atomic<int> count{0};
+    anya::parallel_for_each(set, [&](int) { ++count; });
+    EXPECT_TRUE(count == 1000);
+    anya::unordered_set<int> empty;
+    EXPECT_TRUE(anya::parallel_reduce(empty, 7) == 7);
+
+    // 在默认线程池的任务中调用哈希表的并行插入，二者共用同一个线程池，不会死锁
+    // 几张表在不同的线程上同时分配结点，要使用 malloc_allocator 而不是全局的内存池
+    anya::vector<int> input;
+    for (int i = 0; i < 100000; ++i) input.push_back(i);
+    using set_type = anya::unordered_set<int, anya::hash<int>, std::equal_to<int>, anya::malloc_allocator<int>>;
+    anya::unordered_map<int, set_type> sets;
+    for (int i = 0; i < 4; ++i) sets[i];
+    anya::parallel_for_each(sets, [&](auto& value) { value.second.insert_parallel(input.begin(), input.end(), 4); });
+    for (auto& [key, inner] : sets) EXPECT_TRUE(inner.size() == input.size() && inner.contains(99999));
+}
+
+#endif //ANYA_STL_PARALLEL_TEST_HPP
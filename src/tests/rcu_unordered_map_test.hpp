@@ -0,0 +1,76 @@
+//
+// Created by Anya on 2023/8/12.
+//
+
+#ifndef ANYA_STL_RCU_UNORDERED_MAP_TEST_HPP
+#define ANYA_STL_RCU_UNORDERED_MAP_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/rcu_unordered_map.hpp"
+#include <thread>
+#include <vector>
+
+TEST(RCUUnorderedMapTest, basic) {
+    anya::rcu_unordered_map<std::string, int> map;
+    EXPECT_TRUE(map.empty());
+    for (int i = 0; i < 1000; ++i) EXPECT_TRUE(map.emplace(std::to_string(i), i));
+    EXPECT_FALSE(map.emplace("0", 1));
+    EXPECT_TRUE(map.size() == 1000);
+    EXPECT_TRUE(map.bucket_count() >= 1000);
+    for (int i = 0; i < 1000; ++i) EXPECT_TRUE(map.find(std::to_string(i)) == i);
+    EXPECT_FALSE(map.insert_or_assign("0", 10));
+    EXPECT_TRUE(map.find("0") == 10);
+    EXPECT_TRUE(map.visit("0", [](const int& v) { EXPECT_TRUE(v == 10); }));
+    EXPECT_TRUE(map.erase("0") == 1 && map.erase("0") == 0);
+    EXPECT_FALSE(map.contains("0"));
+    size_t visited = 0;
+    map.for_each([&visited](const auto&) { ++visited; });
+    EXPECT_TRUE(visited == 999);
+    map.clear();
+    EXPECT_TRUE(map.empty() && !map.contains("1"));
+}
+
+TEST(RCUUnorderedMapTest, reclaim) {
+    anya::rcu_unordered_map<int, int> map;
+    map.emplace(1, 1), map.emplace(2, 2);
+    {
+        // 读临界区内摘下的结点不能被回收
+        anya::epoch_guard guard;
+        map.erase(1);
+        map.insert_or_assign(2, 3);
+        EXPECT_TRUE(map.reclaim() == 2);
+    }
+    EXPECT_TRUE(map.reclaim() == 0);
+    EXPECT_TRUE(map.find(2) == 3);
+}
+
+TEST(RCUUnorderedMapTest, concurrent) {
+    anya::rcu_unordered_map<int, int> map;
+    for (int i = 0; i < 1000; ++i) map.emplace(i, i);
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> errors{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                // 偶数key始终存在，值只会是key或者key的相反数
+                for (int i = 0; i < 1000; i += 2) {
+                    auto value = map.find(i);
+                    if (!value || (*value != i && *value != -i)) ++errors;
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 1000; ++i) map.insert_or_assign(i, round % 2 ? -i : i);
+        for (int i = 1; i < 1000; i += 2) map.erase(i);
+        for (int i = 1000; i < 1200; ++i) map.emplace(i + round * 200, i);
+    }
+    stop = true;
+    for (auto& reader : readers) reader.join();
+    EXPECT_TRUE(errors == 0);
+    EXPECT_TRUE(map.reclaim() == 0);
+}
+
+#endif //ANYA_STL_RCU_UNORDERED_MAP_TEST_HPP
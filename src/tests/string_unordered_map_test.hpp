@@ -0,0 +1,102 @@
+//
+// Created by Anya on 2023/8/26.
+//
+
+#ifndef ANYA_STL_STRING_UNORDERED_MAP_TEST_HPP
+#define ANYA_STL_STRING_UNORDERED_MAP_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/string_unordered_map.hpp"
+#include <map>
+#include <string>
+
+TEST(StringUnorderedMapTest, basic) {
+    anya::string_unordered_map<int> map{{"one", 1}, {"two", 2}};
+    EXPECT_TRUE(map.size() == 2 && map.at("two") == 2);
+    EXPECT_TRUE(map.try_emplace("one", 10).second == false && map["one"] == 1);
+    map["three"] = 3;
+    EXPECT_TRUE(map.insert_or_assign("one", 11).second == false && map.at("one") == 11);
+    // 空串、含 '\0' 的key和长key
+    std::string zero("a\0b", 3), longer(1000, 'x');
+    map[""] = 0, map[zero] = 4, map[longer] = 5;
+    EXPECT_TRUE(map.at("") == 0 && map.at(zero) == 4 && map.at(longer) == 5);
+    EXPECT_FALSE(map.contains("a"));
+    EXPECT_THROW(map.at("four"), std::out_of_range);
+    EXPECT_TRUE(map.erase("two") == 1 && map.erase("two") == 0 && map.size() == 5);
+
+    auto it = map.find("three");
+    EXPECT_TRUE(it->first == "three" && it->second == 3 && it.key() == "three");
+    it->second = 30;
+    EXPECT_TRUE(map.at("three") == 30);
+    for (auto [key, value] : map) value += 1;
+    EXPECT_TRUE(map.at("three") == 31 && map.at(longer) == 6);
+}
+
+TEST(StringUnorderedMapTest, compare_with_std) {
+    anya::string_unordered_map<size_t> map;
+    std::map<std::string, size_t> std;
+    for (size_t i = 0; i < 20000; ++i) {
+        std::string key = "key_" + std::to_string(i * 7919 % 5000) + std::string(i % 40, '#');
+        map[key] = i, std[key] = i;
+    }
+    EXPECT_TRUE(map.size() == std.size());
+    EXPECT_TRUE(map.load_factor() <= map.max_load_factor());
+    for (auto& [key, value] : std) EXPECT_TRUE(map.at(key) == value);
+    size_t visited = 0;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        EXPECT_TRUE(std.at(std::string(it.key())) == it.value());
+        ++visited;
+    }
+    EXPECT_TRUE(visited == std.size());
+
+    // 用迭代器边遍历边删除
+    for (auto it = map.begin(); it != map.end();) {
+        if (it.value() % 2) it = map.erase(it);
+        else ++it;
+    }
+    std::erase_if(std, [](auto& kv) { return kv.second % 2; });
+    EXPECT_TRUE(map.size() == std.size());
+    for (auto& [key, value] : std) EXPECT_TRUE(map.at(key) == value);
+
+    // 复制、移动与缩小
+    anya::string_unordered_map<size_t> copy(map);
+    EXPECT_TRUE(copy == map);
+    anya::string_unordered_map<size_t> moved(std::move(copy));
+    EXPECT_TRUE(moved == map && copy.empty());
+    moved.clear();
+    EXPECT_TRUE(moved.empty() && moved.begin() == moved.end());
+    map.rehash(0);
+    EXPECT_TRUE(map.load_factor() <= map.max_load_factor());
+    for (auto& [key, value] : std) EXPECT_TRUE(map.at(key) == value);
+}
+
+TEST(StringUnorderedMapTest, memory) {
+    // 结点只有头、值和key的字符
+    using map_type = anya::string_unordered_map<uint64_t>;
+    EXPECT_TRUE(map_type::node_size(0) == 24 && map_type::node_size(5) == 32 && map_type::node_size(40) == 64);
+    map_type map;
+    for (int i = 0; i < 1000; ++i) map[std::string(i % 64, 'k') + std::to_string(i)] = i;
+    size_t nodes = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) nodes += map_type::node_size(it.key().size());
+    EXPECT_TRUE(map.memory_usage() == nodes + map.bucket_count() * sizeof(void*));
+}
+
+TEST(StringUnorderedMapTest, moved_from) {
+    // 被移动后的表没有桶数组，查找、删除和插入都要能正常使用
+    anya::string_unordered_map<int> map;
+    map["anya"] = 1, map["yor"] = 2;
+    anya::string_unordered_map<int> moved(std::move(map));
+    EXPECT_TRUE(map.empty() && map.begin() == map.end());
+    EXPECT_TRUE(map.find("anya") == map.end() && !map.contains("yor") && map.erase("anya") == 0);
+    EXPECT_TRUE(map.try_emplace("loid", 3).second);
+    EXPECT_FALSE(map.insert_or_assign("loid", 4).second);
+    map["bond"] = 5;
+    EXPECT_TRUE(map.size() == 2 && map.at("loid") == 4 && map.at("bond") == 5);
+
+    moved = std::move(map);
+    map["damian"] = 6;
+    EXPECT_TRUE(map.size() == 1 && map.at("damian") == 6 && moved.size() == 2);
+}
+
+#endif //ANYA_STL_STRING_UNORDERED_MAP_TEST_HPP
@@ -8,6 +8,8 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "container/unordered_map.hpp"
+#include "functional/hash.hpp"
+#include "allocator/node_slab.hpp"
 #include "algorithm/algorithm.h"
 #include <unordered_map>
 
@@ -54,6 +56,31 @@ TEST(UnMapTest, assign) {
     }
 }
 
+TEST(UnMapTest, moved_from) {
+    // 被移动后的表没有桶数组，查找、删除和插入都要能正常使用
+    anya::unordered_map<int, std::string> hash1 = {{1, "anya"}, {2, "yor"}};
+    anya::unordered_map<int, std::string> hash2(std::move(hash1));
+    EXPECT_TRUE(hash1.empty() && hash1.begin() == hash1.end());
+    EXPECT_TRUE(hash1.find(1) == hash1.end() && hash1.count(1) == 0 && !hash1.contains(2));
+    EXPECT_TRUE(hash1.erase(1) == 0);
+    int keys[] = {1, 2};
+    bool found[2] = {true, true};
+    hash1.contains_batch(keys, keys + 2, found);
+    EXPECT_TRUE(!found[0] && !found[1]);
+
+    EXPECT_TRUE(hash1.emplace(1, "loid").second);
+    EXPECT_TRUE(hash1.try_emplace(2, "bond").second);
+    EXPECT_FALSE(hash1.insert_or_assign(2, "yor").second);
+    hash1[3] = "damian";
+    EXPECT_TRUE(hash1.size() == 3 && hash1.at(1) == "loid" && hash1.at(2) == "yor" && hash1.at(3) == "damian");
+
+    hash2 = std::move(hash1);
+    EXPECT_TRUE(hash1.insert_or_assign(4, "becky").second && hash1.size() == 1);
+    hash2 = std::move(hash1);
+    hash1.insert(hash2.begin(), hash2.end());
+    EXPECT_TRUE(hash1 == hash2);
+}
+
 TEST(UnMapTest, capacity) {
     anya::unordered_map<int, int> hash1 = {std::make_pair(6, 6), std::make_pair(6, 6), std::make_pair(6, 6), std::make_pair(6, 6)};
     EXPECT_TRUE(hash1.size() == 1);
@@ -155,4 +182,207 @@ TEST(UnMapTest, find) {
     EXPECT_TRUE(hash1.find(6)->second != hash2.find(6)->second);
 }
 
+TEST(UnMapTest, incremental_rehash) {
+    anya::unordered_map<int, int> map;
+    EXPECT_TRUE(map.incremental_rehash() == 0 && !map.rehashing());
+    map.incremental_rehash(2);
+    EXPECT_TRUE(map.incremental_rehash() == 2);
+    int i = 0;
+    while (!map.rehashing()) map[i] = i, ++i;
+    // 迁移期间新旧桶里的元素都能找到
+    for (int j = 0; j < i; ++j) EXPECT_TRUE(map.at(j) == j);
+    map.incremental_rehash(0);
+    EXPECT_TRUE(!map.rehashing() && map.size() == size_t(i));
+    for (int j = 0; j < i; ++j) EXPECT_TRUE(map.at(j) == j);
+}
+
+// 记录拷贝和移动次数的值类型
+struct tracked_value {
+    inline static int copies = 0;
+    inline static int moves = 0;
+    int value = 0;
+
+    tracked_value() = default;
+    explicit tracked_value(int v) : value(v) {}
+    tracked_value(const tracked_value& other) : value(other.value) { ++copies; }
+    tracked_value(tracked_value&& other) noexcept : value(other.value) { ++moves; }
+    tracked_value& operator=(const tracked_value& other) { value = other.value, ++copies; return *this; }
+    tracked_value& operator=(tracked_value&& other) noexcept { value = other.value, ++moves; return *this; }
+};
+
+TEST(UnMapTest, emplace) {
+    {
+        anya::unordered_map<int, tracked_value> hash;
+        tracked_value::copies = tracked_value::moves = 0;
+        hash.emplace(1, tracked_value(1));
+        EXPECT_TRUE(tracked_value::copies == 0 && tracked_value::moves == 1);
+        // key已存在时不会构造或移动值
+        tracked_value v(2);
+        hash.emplace(1, std::move(v));
+        hash.try_emplace(1, std::move(v));
+        EXPECT_TRUE(tracked_value::copies == 0 && tracked_value::moves == 1);
+        hash.try_emplace(2, 2);
+        EXPECT_TRUE(tracked_value::copies == 0 && tracked_value::moves == 1);
+        EXPECT_TRUE(hash[2].value == 2 && hash[1].value == 1);
+        hash[3];
+        EXPECT_TRUE(tracked_value::copies == 0 && tracked_value::moves == 1);
+        hash.emplace(std::piecewise_construct, std::forward_as_tuple(4), std::forward_as_tuple(4));
+        EXPECT_TRUE(tracked_value::copies == 0 && tracked_value::moves == 1);
+        EXPECT_TRUE(hash.size() == 4 && hash.at(4).value == 4);
+    }
+
+    {
+        anya::unordered_map<std::string, std::unique_ptr<int>> hash;
+        hash.emplace("anya", std::make_unique<int>(0));
+        EXPECT_TRUE(hash.try_emplace("mnzn", std::make_unique<int>(1)).second);
+        EXPECT_FALSE(hash.try_emplace("mnzn", std::make_unique<int>(2)).second);
+        EXPECT_TRUE(*hash.at("mnzn") == 1);
+        EXPECT_FALSE(hash.insert_or_assign("mnzn", std::make_unique<int>(3)).second);
+        EXPECT_TRUE(*hash.at("mnzn") == 3);
+        EXPECT_TRUE(hash.insert_or_assign("neko", std::make_unique<int>(4)).second);
+        EXPECT_TRUE(hash.size() == 3 && *hash["neko"] == 4);
+    }
+}
+
+// 记录 string_view 比较次数，用来确认查找走的是透明重载而没有先构造 std::string
+struct counting_equal {
+    using is_transparent = void;
+    inline static size_t string_views = 0;
+
+    bool
+    operator()(const std::string& lhs, const std::string& rhs) const { return lhs == rhs; }
+
+    bool
+    operator()(const std::string& lhs, std::string_view rhs) const { return ++string_views, lhs == rhs; }
+};
+
+TEST(UnMapTest, transparent) {
+    anya::unordered_map<std::string, int, anya::string_hash, std::equal_to<>> hash;
+    hash.emplace("anya", 0);
+    hash.emplace("mnzn", 1);
+    std::string_view view = "mnzn";
+    EXPECT_TRUE(hash.find(view)->second == 1);
+    EXPECT_TRUE(hash.contains("anya"));
+    EXPECT_TRUE(hash.count(std::string_view("neko")) == 0);
+    EXPECT_TRUE(hash.at(view) == 1);
+    EXPECT_TRUE(hash.equal_range(view).first->second == 1);
+    EXPECT_TRUE(hash.erase(view) == 1);
+    EXPECT_FALSE(hash.contains(view));
+    EXPECT_THROW(hash.at(view), std::out_of_range);
+    EXPECT_TRUE(anya::string_hash{}("anya") == anya::string_hash{}(std::string("anya")));
+
+    anya::unordered_map<std::string, int, anya::string_hash, counting_equal> hash2;
+    hash2.emplace("anya", 0);
+    EXPECT_TRUE(hash2.contains(std::string_view("anya")));
+    EXPECT_TRUE(counting_equal::string_views == 1);
+}
+
+TEST(UnMapTest, batch) {
+    anya::unordered_map<int, int> hash;
+    anya::vector<std::pair<int, int>> values;
+    for (int i = 0; i < 1000; ++i) values.push_back({i % 700, i});
+    EXPECT_TRUE(hash.insert_batch(values.begin(), values.end()) == 700);
+    EXPECT_TRUE(hash.size() == 700);
+    for (int i = 0; i < 700; ++i) EXPECT_TRUE(hash.at(i) == i);
+
+    anya::vector<int> keys;
+    for (int i = 0; i < 1000; ++i) keys.push_back(i * 7 % 1000);
+    anya::vector<anya::unordered_map<int, int>::iterator> found(keys.size());
+    anya::vector<bool> exist(keys.size());
+    hash.find_batch(keys.begin(), keys.end(), found.begin());
+    hash.contains_batch(keys.begin(), keys.end(), exist.begin());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_TRUE(found[i] == hash.find(keys[i]));
+        EXPECT_TRUE(exist[i] == hash.contains(keys[i]));
+    }
+
+    // 透明查找的批量版本
+    anya::unordered_map<std::string, int, anya::string_hash, std::equal_to<>> names{{"anya", 0}, {"mnzn", 1}};
+    std::string_view views[] = {"mnzn", "neko", "anya"};
+    bool result[3];
+    names.contains_batch(views, views + 3, result);
+    EXPECT_TRUE(result[0] && !result[1] && result[2]);
+}
+
+TEST(UnMapTest, node_handle) {
+    anya::unordered_map<std::string, int> hash{{"anya", 0}, {"mnzn", 1}, {"neko", 2}};
+    auto node = hash.extract("anya");
+    EXPECT_TRUE(node && node.key() == "anya" && node.mapped() == 0);
+    EXPECT_TRUE(hash.size() == 2 && !hash.contains("anya"));
+    EXPECT_TRUE(hash.extract("anya").empty());
+
+    // 修改key后重新插入，结点地址不变
+    const auto* address = &node.mapped();
+    node.key() = "yor";
+    auto result = hash.insert(std::move(node));
+    EXPECT_TRUE(result.inserted && node.empty() && result.node.empty());
+    EXPECT_TRUE(&result.position->second == address && hash.at("yor") == 0);
+
+    // key已存在时结点留在返回值中
+    auto duplicate = hash.extract(hash.find("mnzn"));
+    hash.emplace("mnzn", 10);
+    result = hash.insert(std::move(duplicate));
+    EXPECT_FALSE(result.inserted);
+    EXPECT_TRUE(result.position->second == 10 && result.node.mapped() == 1);
+
+    anya::unordered_map<std::string, int> other{{"neko", 20}, {"loid", 3}};
+    const auto* loid = &other.at("loid");
+    hash.merge(other);
+    EXPECT_TRUE(hash.size() == 4 && &hash.at("loid") == loid);
+    EXPECT_TRUE(hash.at("neko") == 2);
+    EXPECT_TRUE(other.size() == 1 && other.at("neko") == 20);
+}
+
+TEST(UnMapTest, slab) {
+    using slab_map = anya::unordered_map<std::string, int, anya::hash<std::string>, std::equal_to<std::string>,
+                                         anya::slab_allocator<std::pair<const std::string, int>>>;
+    slab_map hash;
+    for (int i = 0; i < 1000; ++i) hash.emplace(std::to_string(i), i);
+    EXPECT_TRUE(hash.size() == 1000 && hash.at("500") == 500);
+    for (int i = 0; i < 1000; i += 2) hash.erase(std::to_string(i));
+    EXPECT_TRUE(hash.size() == 500 && !hash.contains("500") && hash.at("501") == 501);
+
+    // clear 后结点池整块归还，可以继续使用
+    hash.clear();
+    EXPECT_TRUE(hash.empty() && hash.begin() == hash.end());
+    hash["anya"] = 1, hash["yor"] = 2;
+    EXPECT_TRUE(hash.size() == 2 && hash.at("yor") == 2);
+
+    slab_map moved(std::move(hash));
+    EXPECT_TRUE(hash.empty() && moved.at("anya") == 1);
+    slab_map other;
+    other.emplace("loid", 3);
+    other.swap(moved);
+    hash = std::move(other);
+    EXPECT_TRUE(hash.size() == 2 && moved.at("loid") == 3);
+    moved = std::move(hash);
+    EXPECT_TRUE(moved.size() == 2 && moved.at("yor") == 2);
+    slab_map copy(moved);
+    moved.clear();
+    EXPECT_TRUE(copy.size() == 2 && copy.at("anya") == 1);
+
+    anya::unordered_map<int, int, anya::hash<int>, std::equal_to<int>, anya::slab_allocator<std::pair<const int, int>>> numbers;
+    anya::vector<std::pair<int, int>> input;
+    for (int i = 0; i < 100000; ++i) input.push_back({i, i});
+    numbers.insert_parallel(input.begin(), input.end(), 4);
+    EXPECT_TRUE(numbers.size() == 100000 && numbers.at(99999) == 99999);
+    numbers.clear();
+    numbers.emplace(1, 1);
+    EXPECT_TRUE(numbers.size() == 1);
+}
+
+TEST(UnMapTest, erase_if) {
+    anya::unordered_map<int, int> hash;
+    for (int i = 0; i < 10000; ++i) hash.emplace(i, i);
+    EXPECT_EQ(anya::erase_if(hash, [](const auto& kv) { return kv.second % 4 != 0; }), 7500u);
+    EXPECT_EQ(hash.size(), 2500u);
+    EXPECT_EQ(anya::distance(hash.begin(), hash.end()), 2500);
+    for (auto& [key, value] : hash) EXPECT_TRUE(key % 4 == 0);
+    EXPECT_TRUE(hash.contains(400) && !hash.contains(401));
+    EXPECT_EQ(anya::erase_if(hash, [](const auto&) { return true; }), 2500u);
+    EXPECT_TRUE(hash.empty() && hash.begin() == hash.end());
+    hash.emplace(1, 1);
+    EXPECT_EQ(hash.at(1), 1);
+}
+
 #endif //ANYA_STL_UNORDERED_MAP_TEST_HPP
@@ -0,0 +1,35 @@
+//
+// Created by Anya on 2023/8/15.
+//
+
+#ifndef ANYA_STL_UNORDERED_MULTIMAP_TEST_HPP
+#define ANYA_STL_UNORDERED_MULTIMAP_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/unordered_multimap.hpp"
+#include <unordered_map>
+
+TEST(UnMultimapTest, all) {
+    anya::unordered_multimap<int, int> map{{1, 1}, {1, 2}, {4, 3}};
+    std::unordered_multimap<int, int> std{{1, 1}, {1, 2}, {4, 3}}, temp;
+    for (int i = 0; i < 1000; ++i) {
+        auto it = map.emplace(i % 300, i);
+        EXPECT_TRUE(it->first == i % 300 && it->second == i);
+        std.emplace(i % 300, i);
+    }
+    for (auto& kv : map) temp.insert(kv);
+    EXPECT_TRUE(std == temp);
+    for (int key = 0; key < 300; ++key) {
+        auto [first, last] = map.equal_range(key);
+        EXPECT_TRUE(size_t(anya::distance(first, last)) == std.count(key));
+    }
+    EXPECT_TRUE(map.erase(1) == std.erase(1));
+    map.find(4)->second = 0;
+
+    anya::unordered_multimap<int, int> other{{4, 4}};
+    other.merge(map);
+    EXPECT_TRUE(map.empty() && other.size() == std.size() + 1 && other.count(4) == 6);
+}
+
+#endif //ANYA_STL_UNORDERED_MULTIMAP_TEST_HPP
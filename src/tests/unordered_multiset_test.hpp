@@ -0,0 +1,34 @@
+//
+// Created by Anya on 2023/8/15.
+//
+
+#ifndef ANYA_STL_UNORDERED_MULTISET_TEST_HPP
+#define ANYA_STL_UNORDERED_MULTISET_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/unordered_multiset.hpp"
+#include <unordered_set>
+
+TEST(UnMultisetTest, all) {
+    anya::unordered_multiset<int> set{1, 1, 4, 5, 1, 4};
+    EXPECT_TRUE(set.size() == 6);
+    EXPECT_TRUE(set.count(1) == 3 && set.count(4) == 2 && set.count(2) == 0);
+    auto [first, last] = set.equal_range(1);
+    EXPECT_TRUE(anya::distance(first, last) == 3);
+
+    std::unordered_multiset<int> std, temp;
+    for (int i = 0; i < 1000; ++i) set.insert(i % 300), std.insert(i % 300);
+    std.insert({1, 1, 4, 5, 1, 4});
+    for (int key : set) temp.insert(key);
+    EXPECT_TRUE(std == temp);
+    EXPECT_TRUE(set.erase(1) == std.erase(1));
+
+    anya::unordered_multiset<int> other{4, 4};
+    set.merge(other);
+    EXPECT_TRUE(other.empty() && set.count(4) == 8);
+    set.insert(set.extract(5));
+    EXPECT_TRUE(set.count(5) == 5);
+}
+
+#endif //ANYA_STL_UNORDERED_MULTISET_TEST_HPP
@@ -0,0 +1,60 @@
+//
+// Created by Anya on 2023/8/15.
+//
+
+#ifndef ANYA_STL_UNORDERED_SET_TEST_HPP
+#define ANYA_STL_UNORDERED_SET_TEST_HPP
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "container/unordered_set.hpp"
+#include "functional/hash.hpp"
+#include <unordered_set>
+
+TEST(UnSetTest, construct) {
+    anya::unordered_set<int> set{1, 1, 4, 5, 1, 4};
+    EXPECT_TRUE(set.size() == 3);
+    anya::unordered_set<int> copy = set;
+    EXPECT_TRUE(copy == set);
+    anya::unordered_set<int> moved = std::move(copy);
+    EXPECT_TRUE(moved == set && copy.empty());
+}
+
+TEST(UnSetTest, modify) {
+    anya::unordered_set<std::string> set;
+    std::unordered_set<std::string> std, temp;
+    for (int i = 0; i < 1000; ++i) {
+        auto [it, inserted] = set.insert(std::to_string(i % 700));
+        EXPECT_TRUE(*it == std::to_string(i % 700));
+        EXPECT_TRUE(inserted == std.insert(std::to_string(i % 700)).second);
+    }
+    for (auto& key : set) temp.insert(key);
+    EXPECT_TRUE(std == temp);
+    EXPECT_TRUE(set.count("1") == 1 && set.contains("699") && !set.contains("700"));
+    EXPECT_TRUE(set.erase("1") == 1 && set.erase("1") == 0);
+    set.erase(set.find("2"));
+    EXPECT_TRUE(set.size() == 698);
+
+    auto node = set.extract("3");
+    node.value() = "anya";
+    EXPECT_TRUE(set.insert(std::move(node)).inserted);
+    anya::unordered_set<std::string> other{"anya", "mnzn"};
+    set.merge(other);
+    EXPECT_TRUE(set.contains("mnzn") && other.size() == 1 && other.contains("anya"));
+}
+
+TEST(UnSetTest, transparent) {
+    anya::unordered_set<std::string, anya::string_hash, std::equal_to<>> set{"anya", "mnzn"};
+    std::string_view view = "anya";
+    EXPECT_TRUE(set.contains(view));
+    EXPECT_TRUE(*set.find(view) == "anya");
+    EXPECT_TRUE(set.erase(view) == 1 && !set.contains(view));
+}
+
+TEST(UnSetTest, erase_if) {
+    anya::unordered_set<std::string> set{"anya", "yor", "loid", "bond", "neko"};
+    EXPECT_EQ(anya::erase_if(set, [](const std::string& s) { return s.size() == 4; }), 4u);
+    EXPECT_TRUE(set.size() == 1 && set.contains("yor"));
+}
+
+#endif //ANYA_STL_UNORDERED_SET_TEST_HPP
@@ -259,4 +259,15 @@ TEST(VecTest, dilatation) {
 
 }
 
+TEST(VecTest, erase_if) {
+    anya::vector<std::string> anya;
+    for (int i = 0; i < 100; ++i) anya.push_back(std::to_string(i));
+    EXPECT_EQ(anya::erase_if(anya, [](const std::string& s) { return s.back() == '0'; }), 10u);
+    EXPECT_EQ(anya.size(), 90u);
+    EXPECT_TRUE(anya.front() == "1" && anya[8] == "9" && anya[9] == "11" && anya.back() == "99");
+    EXPECT_EQ(anya::erase_if(anya, [](const std::string&) { return false; }), 0u);
+    EXPECT_EQ(anya::erase_if(anya, [](const std::string&) { return true; }), 90u);
+    EXPECT_TRUE(anya.empty());
+}
+
 #endif //ANYA_STL_VECTOR_TEST_HPP